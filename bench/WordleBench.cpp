@@ -0,0 +1,246 @@
+#include <benchmark/benchmark.h>
+#include "LowerBound.hpp"
+#include "MemoizationTable.hpp"
+#include "Solver.hpp"
+#include "Wordle.hpp"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+/*
+ * Micro-benchmarks for the kernels the search spends its time in, so a speedup or regression can be pinned on one
+ *   - Everything runs on the full game (data/answers.txt and data/guesses.txt) at the width main would pick for it
+ *   - State sizes are the benchmark's argument. A state of size s is always the same s answers (seeded with s), so
+ *       numbers from two builds are comparable
+ */
+
+namespace {
+
+constexpr int W = 2368; // What main picks for answers.txt
+
+// The full game, loaded and its LUT built once for every benchmark
+struct Fixture {
+    Config config;
+    std::unique_ptr<Wordle> game;
+    GuessBitset all_guesses;
+
+    Fixture() {
+        config.answers_path = WORDLE_DATA_DIR "/answers.txt";
+        config.guesses_path = WORDLE_DATA_DIR "/guesses.txt";
+        config.agnostic_reserve = config.specific_reserve = config.bound_reserve = 1000; // Tables get made per iteration
+        game = std::make_unique<Wordle>(config);
+        game->build_lut();
+        all_guesses.set_first(game->num_guesses());
+    }
+};
+
+const Fixture& fixture() {
+    static Fixture f;
+    return f;
+}
+
+// size answers picked at random, the same ones every run
+StateBitset<W> fixture_state(int size) {
+    int num_answers = fixture().game->num_answers();
+    std::vector<int> answers(num_answers);
+    for (int i = 0; i < num_answers; ++i) answers[i] = i;
+    std::shuffle(answers.begin(), answers.end(), std::mt19937(size));
+
+    StateBitset<W> state;
+    for (int i = 0; i < std::min(size, num_answers); ++i) state.set(answers[i]);
+    return state;
+}
+
+void state_sizes(benchmark::internal::Benchmark* b) {
+    for (int size : {8, 64, 512, 2315}) b->Arg(size);
+}
+
+// -- Wordle --
+
+void BM_ComputePattern(benchmark::State& state) {
+    const Wordle& game = *fixture().game;
+    int g = 0, a = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Wordle::compute_pattern(game.get_guess_str(g), game.get_answer_str(a)));
+        g = (g + 1) % game.num_guesses();
+        a = (a + 7) % game.num_answers();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ComputePattern);
+
+void BM_BuildLut(benchmark::State& state) {
+    Wordle game(fixture().config);
+    for (auto _ : state) game.build_lut();
+    state.SetItemsProcessed(state.iterations() * game.num_guesses() * game.num_answers());
+}
+BENCHMARK(BM_BuildLut)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Every guess in turn, pruned on the pattern it gives the state's first answer (which always keeps something)
+void BM_PruneState(benchmark::State& state) {
+    const Wordle& game = *fixture().game;
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    int first = *current.begin();
+    int g = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(game.prune_state(current, g, game.get_pattern_lookup(g, first)));
+        g = (g + 1) % game.num_guesses();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PruneState)->Apply(state_sizes);
+
+void BM_CountPatterns(benchmark::State& state) {
+    const Wordle& game = *fixture().game;
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    std::array<int, NUM_PATTERNS> counts;
+    int g = 0;
+    for (auto _ : state) {
+        game.count_patterns(current, g, counts);
+        benchmark::DoNotOptimize(counts.data());
+        g = (g + 1) % game.num_guesses();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CountPatterns)->Apply(state_sizes);
+
+void BM_PartitionState(benchmark::State& state) {
+    const Wordle& game = *fixture().game;
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    auto partition = std::make_unique<Partition<W>>(); // 243 states, too big for the stack
+    int g = 0;
+    for (auto _ : state) {
+        game.partition_state(current, g, *partition);
+        benchmark::DoNotOptimize(partition->num_patterns);
+        g = (g + 1) % game.num_guesses();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PartitionState)->Apply(state_sizes);
+
+// -- Solver --
+
+// Over every guess, as a root (or near root) state sees them
+void BM_PruneActions(benchmark::State& state) {
+    const Fixture& f = fixture();
+    MemoizationTable<W> cache(f.config);
+    LowerBound<W> bounds(f.config, *f.game);
+    Solver<W> solver(f.config, *f.game, cache, bounds);
+
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    GuessBitset useful;
+    for (auto _ : state) {
+        solver.prune_actions(current, f.all_guesses, useful);
+        benchmark::DoNotOptimize(useful.words);
+    }
+    state.SetItemsProcessed(state.iterations() * f.game->num_guesses());
+}
+BENCHMARK(BM_PruneActions)->Apply(state_sizes)->Unit(benchmark::kMicrosecond);
+
+// A whole subtree below one guess, from empty tables each time so nothing carries over
+// Depth 3 keeps the bigger states to a few guesses deep, like they'd be in a real search
+void BM_EvaluateGuess(benchmark::State& state) {
+    const Fixture& f = fixture();
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    int guess = *current.begin(); // The guesses list starts with the answers
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto cache = std::make_unique<MemoizationTable<W>>(f.config);
+        auto bounds = std::make_unique<LowerBound<W>>(f.config, *f.game);
+        Solver<W> solver(f.config, *f.game, *cache, *bounds);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(solver.evaluate_guess(current, guess, f.all_guesses, 3));
+    }
+}
+BENCHMARK(BM_EvaluateGuess)->Arg(8)->Arg(32)->Arg(128)->Unit(benchmark::kMillisecond);
+
+// -- MemoizationTable --
+
+// Shared between the threads of one run, made by thread 0 before they start
+std::unique_ptr<Config> memo_config;
+std::unique_ptr<MemoizationTable<W>> memo;
+
+constexpr int PREFILLED = 1 << 14;
+
+// A distinct state per (thread, i), at a realistic 64 answers. The base is fixed, only the first word changes
+StateBitset<W> memo_key(const StateBitset<W>& base, int thread, int64_t i) {
+    StateBitset<W> key = base;
+    key.words[0] = (static_cast<uint64_t>(thread) << 48) | static_cast<uint64_t>(i);
+    return key;
+}
+
+void make_memo(const benchmark::State& state) {
+    memo_config = std::make_unique<Config>(fixture().config);
+    memo_config->memo_backend = static_cast<MemoBackendType>(state.range(0));
+    memo = std::make_unique<MemoizationTable<W>>(*memo_config);
+}
+
+void memo_backends(benchmark::internal::Benchmark* b) {
+    for (MemoBackendType type : {MemoBackendType::Exact, MemoBackendType::Fingerprint, MemoBackendType::LockFree})
+        b->Arg(static_cast<int>(type));
+    b->ThreadRange(1, 8)->UseRealTime();
+}
+
+// Hits, on entries every thread reads
+void BM_MemoGet(benchmark::State& state) {
+    StateBitset<W> base = fixture_state(64);
+    if (state.thread_index() == 0) {
+        make_memo(state);
+        for (int i = 0; i < PREFILLED; ++i) memo->insert(memo_key(base, 0, i), 3, SearchResult{2.5, 0, 2});
+    }
+
+    int64_t i = state.thread_index() * 977;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(memo->get(memo_key(base, 0, i % PREFILLED), 3));
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(memo_backend_name(static_cast<MemoBackendType>(state.range(0))));
+}
+BENCHMARK(BM_MemoGet)->Apply(memo_backends);
+
+// Fresh entries only, so every insert really adds one. Capped, since the table only grows
+void BM_MemoInsert(benchmark::State& state) {
+    StateBitset<W> base = fixture_state(64);
+    if (state.thread_index() == 0) make_memo(state);
+
+    int64_t i = 0;
+    for (auto _ : state) memo->insert(memo_key(base, state.thread_index(), i++), 3, SearchResult{2.5, 0, 2});
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(memo_backend_name(static_cast<MemoBackendType>(state.range(0))));
+}
+BENCHMARK(BM_MemoInsert)->Apply(memo_backends)->Iterations(1 << 16);
+
+// -- FastBitset --
+
+void BM_BitsetIterate(benchmark::State& state) {
+    StateBitset<W> current = fixture_state(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        int sum = 0;
+        for (int a : current) sum += a;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * current.count());
+}
+BENCHMARK(BM_BitsetIterate)->Apply(state_sizes);
+
+template <int N>
+void BM_BitsetHash(benchmark::State& state) {
+    StateBitset<N> current;
+    current.set_first(N / 3);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(current); // Or the hash of a constant gets folded away
+        benchmark::DoNotOptimize(std::hash<StateBitset<N>>{}(current));
+    }
+    state.SetBytesProcessed(state.iterations() * sizeof(current.words));
+}
+#define BENCH_HASH(WIDTH) BENCHMARK_TEMPLATE(BM_BitsetHash, WIDTH);
+WORDLE_STATE_WIDTHS(BENCH_HASH)
+#undef BENCH_HASH
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -1,19 +1,24 @@
 # NOTE: This is AI generated, just a nice little graphic
+# Plots one workload's wall times out of perf/history.jsonl (see perf/regress.py)
+#   python3 gen_graph.py [workload] [host]
+
+import json
+import sys
 
 import matplotlib.pyplot as plt
 
-# --- YOUR DATA HERE ---
-# Format: ("YYYY-MM-DD", time_in_seconds, "Label/Commit Name")
-data = [
-    ("2026-01-04", 294.24, "Initial Parallel Model"),
-    ("2026-01-05", 248.14, "Action Pruning"),
-    ("2026-01-06", 65.3, "Wordle LUT"),
-    ("2026-01-19", 55.89, "FastBitset Iterator"),
-    ("2026-01-24", 40.77, "SIMD State Pruning"),
-    ("2026-01-25", 109.23, "Locking Bugfix :("),
-    ("2026-01-26", 88.77, "Non-Linear Guess Ordering")
-]
-# ----------------------
+workload = sys.argv[1] if len(sys.argv) > 1 else "small"
+host = sys.argv[2] if len(sys.argv) > 2 else None
+
+# Format: ("YYYY-MM-DD", time_in_seconds, "Label/Commit Name"), in the order they were recorded
+# The early entries were timed by hand before the harness, so they have no commit or host
+with open('perf/history.jsonl') as f:
+    entries = [json.loads(line) for line in f if line.strip()]
+data = [(e["date"], e["wall_s"], e["label"]) for e in entries
+        if e["workload"] == workload and (host is None or e["host"] in (host, None))]
+if not data:
+    sys.exit(f"No history for {workload}")
+about = [e["about"] for e in entries if e["workload"] == workload][-1]
 
 # Unpack data
 dates = [d[0] for d in data] # Keep as strings, not datetime objects
@@ -42,7 +47,7 @@ for i, txt in enumerate(labels):
                 arrowprops=dict(arrowstyle='-', color='gray'))
 
 # Formatting
-ax.set_title('Solver Optimization - 50 answers, full guesses', fontsize=16, fontweight='bold', pad=20)
+ax.set_title(f'Solver Optimization - {about}', fontsize=16, fontweight='bold', pad=20)
 ax.set_ylabel('Benchmark Time (seconds)', fontsize=12)
 ax.set_xlabel('Date / Commit', fontsize=12)
 
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "MemoizationTable.hpp"
+#include "Wordle.hpp"
+#include <string>
+#include <vector>
+
+// Progress over the root guesses. Everything main needs to pick a run back up, besides the memo
+struct RunState {
+    std::vector<int> completed; // Guess indices of the openers that are fully solved
+    std::vector<double> costs;  // Same order as completed
+    std::vector<uint8_t> cut;   // Same order. Set if --top-k cut the opener, and its cost is only a lower bound
+    double global_min = 1000; // Just start high
+    int best_index = -1; // None yet
+};
+
+/*
+ * A checkpoint is the RunState plus a MemoizationTable dump, tagged with the word lists and state width it came from
+ * It's written to path + ".tmp" and renamed over path, so a job killed mid-save still leaves the last good one
+ */
+template <int N>
+void save_checkpoint(const std::string& path, const Wordle& game, const RunState& state, const MemoizationTable<N>& cache);
+
+// False if there's no checkpoint at path. Throws if it's from different word lists or is malformed
+template <int N>
+bool load_checkpoint(const std::string& path, const Wordle& game, RunState& state, MemoizationTable<N>& cache);
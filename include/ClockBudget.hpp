@@ -0,0 +1,103 @@
+#pragma once
+#include "Statistics.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * A byte budget enforced with CLOCK eviction, over phmap parallel maps whose values have a uint8_t credit field
+ * The memo backends use it for Config::memo_budget_mb, and LowerBound's caches for Config::bound_budget_mb
+ *   - Every entry has a few credits, more for bigger (more expensive to redo) states, plus one per hit
+ *   - Once over budget, an insert sweeps the submap it went into from where its last sweep stopped,
+ *       taking a credit from each entry, and evicting the ones with none left
+ *   - Everything kept this way can be worked out again, so eviction only costs the time to redo it
+ */
+class ClockBudget {
+public:
+    // Evicted entries are counted in t_stats.*evictions
+    ClockBudget(size_t budget, long SolverStats::*evictions) : budget_bytes(budget), eviction_stat(evictions) {}
+
+    ClockBudget(const ClockBudget&) = delete;
+    ClockBudget& operator=(const ClockBudget&) = delete;
+
+    // Live estimate of what the entries take up, without locking anything
+    size_t memory_bytes() const { return used_bytes.load(std::memory_order_relaxed); }
+
+protected:
+    static constexpr uint8_t MAX_CREDIT = 15;
+
+    static uint8_t initial_credit(int count) {
+        // Cost weighted: a state twice the size is roughly one more level of search to redo, so one more credit
+        int credit = 1;
+        while (count > 1 && credit < MAX_CREDIT) {
+            count >>= 1;
+            credit++;
+        }
+        return static_cast<uint8_t>(credit);
+    }
+
+    // try_emplace, plus the accounting and eviction. True if it was new
+    template <typename Map, typename Key, typename Entry>
+    bool emplace(Map& map, std::array<size_t, Map::subcnt()>& hands, const Key& key, Entry entry, size_t entry_bytes) {
+        bool inserted = map.try_emplace(key, entry).second;
+        if (inserted) added(map, hands, key, entry_bytes);
+        return inserted;
+    }
+
+    // Accounting and eviction for a slot that was just added to map under key
+    template <typename Map, typename Key>
+    void added(Map& map, std::array<size_t, Map::subcnt()>& hands, const Key& key, size_t entry_bytes) {
+        size_t used = used_bytes.fetch_add(entry_bytes, std::memory_order_relaxed) + entry_bytes;
+        if (budget_bytes != 0 && used > budget_bytes) {
+            // Inserts are spread evenly over the submaps by hash, so trimming the one just used keeps them all even
+            size_t submap = map.subidx(map.hash(key));
+            evict(map, submap, hands[submap], entry_bytes);
+        }
+    }
+
+    // One CLOCK sweep over a submap, until about a tenth of it is gone
+    template <typename Map>
+    void evict(Map& map, size_t submap, size_t& hand, size_t entry_bytes) {
+        size_t evicted = 0;
+
+        map.with_submap_m(submap, [&](auto& set) {
+            size_t size = set.size();
+            size_t want = std::max<size_t>(size / 10, 1);
+            size_t max_steps = size * (MAX_CREDIT + 1); // Every entry is out of credit by then
+
+            // Pick the hand back up where it was
+            auto it = set.begin();
+            size_t pos = 0;
+            for (; pos < hand && it != set.end(); ++pos) ++it;
+
+            for (size_t step = 0; evicted < want && step < max_steps && !set.empty(); ++step) {
+                if (it == set.end()) {
+                    it = set.begin();
+                    pos = 0;
+                }
+
+                if (it->second.credit == 0) {
+                    set.erase(it++);
+                    evicted++;
+                } else {
+                    it->second.credit--;
+                    ++it;
+                    ++pos;
+                }
+            }
+
+            hand = pos;
+        });
+
+        used_bytes.fetch_sub(evicted * entry_bytes, std::memory_order_relaxed);
+        t_stats.*eviction_stat += evicted;
+    }
+
+    size_t budget_bytes; // 0 is unlimited
+    std::atomic<size_t> used_bytes {0};
+
+private:
+    long SolverStats::*eviction_stat;
+};
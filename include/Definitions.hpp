@@ -1,26 +1,34 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 
 #include "FastBitset.hpp"
 
 constexpr int NUM_PATTERNS = 243;
 
-// These must match, can only be constexpr
-constexpr int NUM_ANSWERS = 50;     // Must match in file
-constexpr const char* ANSWERS_PATH = "data/answers_small.txt";
+// The engine (Solver, MemoizationTable, ...) is templated on the state width so FastBitset keeps its
+// compile time size. These are the widths that get compiled, and main picks the smallest that fits the answers
+#define WORDLE_STATE_WIDTHS(X) X(64) X(128) X(256) X(512) X(1024) X(2368)
+constexpr int MAX_STATE_WIDTH = 2368;
 
-//
-constexpr int NUM_GUESSES = 12972;  // Must match in file
-constexpr const char* GUESSES_PATH = "data/guesses.txt";
+// Guess sets are only ever passed around whole, so one width covers every guess file up to this size
+constexpr int MAX_GUESSES = 12972;
 
-using StateBitset = FastBitset<NUM_ANSWERS>;
-using GuessBitset = FastBitset<NUM_GUESSES>;
+template <int N>
+using StateBitset = FastBitset<N>;
+using GuessBitset = FastBitset<MAX_GUESSES>;
+
+// What solve_state settles on when no guess does better (e.g. every guess runs into the fail cost)
+constexpr double UNSOLVED_COST = 1000.0;
+constexpr double NO_BUDGET = std::numeric_limits<double>::infinity();
 
 struct SearchResult {
     double expected_cost;
     int best_guess_index; // -1 if not applicable (e.g. leaf node)
     int max_height;       // Depth of the subtree relative to this node
+    bool is_cut = false;  // Search stopped once it couldn't beat the budget, so expected_cost is only a lower bound
 
     // Helper for comparisons if you switch to std::min_element later
     bool operator<(const SearchResult& other) const {
@@ -28,18 +36,86 @@ struct SearchResult {
     }
 };
 
+// How solve_state orders the guesses it searches. Good guesses first means tighter budgets sooner
+enum class GuessOrder : uint8_t {
+    Index,         // Plain index order
+    BucketCount,   // Most buckets first
+    LargestBucket, // Smallest worst-case bucket first
+    Entropy        // Most information first
+};
+
+// Which instruction set the LUT kernels use. Auto picks the widest this CPU supports
+enum class KernelPath : uint8_t {
+    Auto,
+    Scalar, // Portable SWAR, runs anywhere
+    AVX2,
+    AVX512  // Needs AVX512BW for the byte compares
+};
+
+// What a thread does when the state it missed on is already being solved by another one (see Solver::solve_state)
+enum class ClaimPolicy : uint8_t {
+    Off,  // Solve it again anyway
+    Wait, // Spin until the other thread's result is in the memo
+    Help, // Same, but run queued OpenMP tasks (often that state's own buckets) while waiting
+    Defer // evaluate_guess solves its other buckets first, then waits on whatever is still in flight
+};
+
+// How hard prune_actions looks for guesses whose partition another guess refines (see Solver::prune_actions)
+enum class DominancePolicy : uint8_t {
+    Off,
+    Approximate, // Only against the few guesses with the most buckets
+    Exact        // Against every guess with at least as many buckets
+};
+
+// Where MemoizationTable keeps its entries (see MemoizationTable.hpp)
+enum class MemoBackendType : uint8_t {
+    Exact,      // Whole states as keys
+    Fingerprint, // 128 bit fingerprints as keys, 32 byte slots
+    LockFree     // Whole states, in a fixed size insert-only table with no locks
+};
+
 struct Config {
     std::string answers_path = "data/answers_small.txt";
     std::string guesses_path = "data/guesses.txt";
+    std::string openers_path = ""; // Only these words (one per line) are tried as openers. Empty for every guess
 
     int num_threads = 8;
-    bool enable_checkpointing = false;
+    int task_depth = 0; // evaluate_guess calls this shallow split their buckets into OpenMP tasks (root is depth 1). 0 is root only
+    int task_min_size = 32; // Buckets smaller than this are never worth a task, so they're solved inline
+    bool enable_checkpointing = false; // Resumes from checkpoint_path if it's there, and saves to it periodically
+    std::string checkpoint_path = "wordle.ckpt";
+    int checkpoint_interval = 600; // Seconds between saves
+    std::string memo_store_path = ""; // Read-only MemoStore behind the memo, for warm starts. Empty for none
 
+    MemoBackendType memo_backend = MemoBackendType::Exact;
+    bool memo_verify = false; // Fingerprint backend only: also keep every state, and count fingerprint collisions
+    ClaimPolicy claim_policy = ClaimPolicy::Defer;
+    int claim_min_size = 16; // States smaller than this are cheaper to redo than to claim
+    int memo_budget_mb = 0; // Cap on the memo tables, enforced by CLOCK eviction. 0 is unlimited
+    int bound_budget_mb = 0; // Same, for LowerBound's bucket and proven caches
+    int lockfree_slots_log2 = 22; // LockFree backend's table size when there's no budget to size it from
     int agnostic_reserve = 100000;
     int specific_reserve = 100000;
+    int bound_reserve = 100000;
 
     int prune_threshold = 20;
+    int small_state_max = 4; // States this small skip the memo and get solved outright by Solver::solve_small (at most 5)
+    DominancePolicy dominance = DominancePolicy::Approximate;
+    int dominance_width = 4; // How many of the finest guesses Approximate checks against
+    bool enable_cutoffs = true; // Branch and bound: stop evaluating a guess once it can't beat its siblings
+    bool partition_bounds = true; // Tighter (cached) bucket bounds in branch and bound
+    bool deep_cutoffs = false; // Also hand budgets down to children, and remember the bounds of cut states
+    int top_k = 0; // Only the best k openers get exact costs, the rest are cut once they can't make it. 0 solves them all
+    GuessOrder guess_order = GuessOrder::BucketCount;
+    int order_top_k = 0; // Only move the best k to the front (rest stay in index order). 0 sorts them all
     double fail_cost = 1e9;
+    KernelPath kernel_path = KernelPath::Auto;
+
+    // WordleSolverMPI only (see Distributed.hpp)
+    int exchange_interval = 30; // Seconds between sending memo entries to the other ranks
+    int share_min_size = 32; // Only states at least this big are worth sending
+    int share_max_depth = 3; // And only specific values this shallow (agnostic ones go at any depth)
 
-    int stats_print_freq = 2000;
+    int stats_print_freq = 60; // Seconds between progress reports (see Progress.hpp). 0 turns them off
+    std::string progress_json_path = ""; // Also appends each report here as a JSON line. Empty for none
 };
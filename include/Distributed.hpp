@@ -0,0 +1,85 @@
+#pragma once
+#include "Checkpoint.hpp"
+#include "Definitions.hpp"
+#include "MemoizationTable.hpp"
+#include "Statistics.hpp"
+#include "Wordle.hpp"
+
+#include <mpi.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <parallel_hashmap/phmap.h>
+#include <vector>
+
+/*
+ * Multi-process runs over MPI, only built into WordleSolverMPI. Every rank is a whole OpenMP solver with its own memo
+ *   - Rank 0 holds the ticket counter, and every rank takes tickets off it with MPI_Fetch_and_op. Ranks all shuffle
+ *       the openers the same way, so a ticket means the same opener everywhere, and ranks share them like threads do
+ *   - Every --exchange-interval seconds a rank sends the entries it has added that are worth sending (states of at least
+ *       --share-min-size answers, and specific values no deeper than --share-max-depth) to every other rank. The
+ *       messages are the memo dump layout, so the receiver just inserts them. Nothing waits on another rank for this
+ *   - Each message also carries the sender's top-k bar. Any rank's k-th best is an upper bound on the global one,
+ *       so every rank cuts openers against the lowest bar it's heard of
+ *   - At the end every rank tells the others it's done, and the opener results and stats are gathered on rank 0
+ *
+ * MPI is only ever called under one mutex, so MPI_THREAD_SERIALIZED is enough
+ */
+template <int N>
+class Distributed {
+public:
+    // Needs MPI to be initialized already. root_budget is main's shared top-k bar, lowered by what other ranks send
+    Distributed(const Config& c, MemoizationTable<N>& m, std::atomic<double>& root_budget);
+    ~Distributed();
+
+    int rank() const { return my_rank; }
+    int size() const { return num_ranks; }
+
+    // The next ticket across every rank. Any thread
+    int next_ticket();
+
+    // Sends and takes in entries if the interval has passed since the last exchange. Any thread, and returns
+    // straight away if another one is already exchanging
+    void maybe_exchange();
+
+    // Once this rank is out of tickets. Sends what's left, then waits for every other rank to be done as well
+    void finish();
+
+    // Every rank's completed openers and stats, on rank 0. The other ranks get theirs back unchanged
+    RunState gather(const RunState& local, SolverStats& stats);
+
+private:
+    static constexpr int TAG_ENTRIES = 1;
+    static constexpr int TAG_DONE = 2;
+
+    const Config& config;
+    MemoizationTable<N>& cache;
+    std::atomic<double>& root_budget;
+
+    int my_rank = 0;
+    int num_ranks = 1;
+
+    std::mutex mpi_mutex;
+    MPI_Win ticket_window;
+    int* ticket_counter = nullptr; // Only allocated on rank 0
+
+    std::mutex exchange_mutex;
+    std::chrono::steady_clock::time_point last_exchange;
+
+    // Entries already sent or received, as a hash of (state, depth), so none go round twice
+    phmap::flat_hash_set<uint64_t> shared;
+
+    // Sends still in flight. Each buffer goes to every other rank
+    struct Outgoing {
+        std::vector<char> message;
+        std::vector<MPI_Request> requests;
+    };
+    std::vector<Outgoing> outgoing;
+
+    void exchange();
+    void send_new_entries();
+    void receive_entries(bool insert);
+    void reap_sends(bool wait);
+
+    static uint64_t share_key(const StateBitset<N>& state, int depth);
+};
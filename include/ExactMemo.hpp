@@ -0,0 +1,87 @@
+#pragma once
+#include "MemoBackend.hpp"
+#include "Profile.hpp"
+#include <parallel_hashmap/phmap.h>
+
+/*
+ * The default backend, keyed on whole states. Each state holds two kinds of value
+ * The Agnostic value:
+ *   - Can only work when the final value was untainted by going past 6 guesses
+ *   - Stores the value and how far down the subtree it had to go to get it
+ *   - In getting, if the get callee is far enough up that the subtree wouldn't reach 7
+ *       then it's able to use that value, because it wouldn't ever hit fail
+ * The Specific values:
+ *   - Store tainted final values (moved by the fail value)
+ *   - Just the final value, one slot per depth 1-6, since it only holds at the depth it was found
+ *   - This is the failover when the agnostic value is missing or too tall for the depth
+ *   - Likely mostly for the small states, since they're the most likely to use a fail value
+ *
+ * It has to be done like this for two reasons
+ * 1. Cached values must know their depth
+ *      If we tried without it, then the 1e9 value assigned to a bitset at depth 6 is the same as that one at depth 2
+ * 2. That was way too slow, and resulted in a 50x cache miss rate
+ *      This method gets it much closer to no-depth with around 5x the miss rate
+ *
+ * Both kinds live inline in one entry, so any (state, depth) is one hash and one locked probe,
+ * and an insert fills in a slot of the entry that's already there
+ */
+template <int N>
+class ExactMemo : public MemoBackend<N> {
+public:
+    explicit ExactMemo(const Config& c);
+
+    std::optional<SearchResult> get(const StateBitset<N>& state, int depth) override;
+    MemoInsert insert(const StateBitset<N>& state, int depth, const SearchResult& res) override;
+
+    void save(std::ostream& out) const override;
+    void load(std::istream& in) override;
+
+    // Values, not states, so it matches what for_each gives. Walks the whole map
+    size_t size() const override;
+
+    void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const override;
+
+private:
+    using MemoBackend<N>::MAX_CREDIT;
+    using MemoBackend<N>::initial_credit;
+    using MemoBackend<N>::added;
+
+    static constexpr int MAX_DEPTH = 6;
+    static constexpr uint8_t AGNOSTIC_BIT = 1; // Bit d of present is depth d's specific value
+
+    struct Entry {
+        double agnostic_cost;
+        double specific_cost[MAX_DEPTH];
+        int16_t agnostic_guess;
+        int16_t specific_guess[MAX_DEPTH];
+        uint8_t agnostic_height;
+        uint8_t present;
+        uint8_t credit; // CLOCK credits left before eviction
+    };
+
+    struct StateHash {
+        std::size_t operator()(const StateBitset<N>& state) const noexcept {
+            return std::hash<StateBitset<N>>{}(state);
+        }
+    };
+
+    using Map = phmap::parallel_flat_hash_map<
+        StateBitset<N>,
+        Entry,
+        StateHash,
+        std::equal_to<StateBitset<N>>,
+        std::allocator<std::pair<const StateBitset<N>, Entry>>,
+        9, // Means 2^9 strips
+        MemoMutex
+    >;
+
+    Map map;
+
+    // Fills in the value's slot. False if it was already filled
+    static bool fill(Entry& entry, int depth, const SearchResult& result);
+
+    // A flat map slot is the pair plus a control byte
+    static constexpr size_t ENTRY_BYTES = sizeof(typename Map::value_type) + 1;
+
+    std::array<size_t, Map::subcnt()> hands = {0}; // Where each submap's last sweep stopped
+};
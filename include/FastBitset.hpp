@@ -39,6 +39,13 @@ struct FastBitset {
         // Pretty much the same thing as reset, but does a 1 and an or
     }
 
+    // Sets just [0, count), for when the real set is smaller than N
+    void set_first(int count) {
+        reset();
+        for (int w = 0; w < count / 64; ++w) words[w] = ~0ULL;
+        if (count % 64 != 0) words[count / 64] = (1ULL << (count % 64)) - 1;
+    }
+
     bool test(int pos) const {
         return (words[pos / 64] & (1ULL << (pos % 64))) != 0;
         // 1ULL portion masks everything but that
@@ -58,6 +65,20 @@ struct FastBitset {
         return false;
     }
 
+    // [first, last] words with any bits set, so loops over a sparse state can skip the zero words around it
+    // An empty bitset gives an empty range (first > last)
+    int first_word() const {
+        for (int w = 0; w < NUM_WORDS; ++w)
+            if (words[w] != 0) return w;
+        return NUM_WORDS;
+    }
+
+    int last_word() const {
+        for (int w = NUM_WORDS - 1; w >= 0; --w)
+            if (words[w] != 0) return w;
+        return -1;
+    }
+
     bool operator==(const FastBitset<N>& other) const {
         for (int w = 0; w < NUM_WORDS; ++w)
             if (words[w] != other.words[w]) return false;
@@ -0,0 +1,97 @@
+#pragma once
+#include "MemoBackend.hpp"
+#include "Profile.hpp"
+#include <parallel_hashmap/phmap.h>
+
+/*
+ * Compact backend, keyed on a 128 bit fingerprint of the state instead of the state itself
+ * Same agnostic/specific split as ExactMemo, but a slot is 32 bytes (key 16, entry 16) instead of a
+ *   whole state plus entry, so a probe reads one cache line and compares two words
+ *   - The specific key is the state's fingerprint with the depth folded in
+ *   - Two states sharing a fingerprint would share an entry. At 2^-128 per pair that's
+ *       never going to happen in a run, but Config::memo_verify keeps every state next to its fingerprint
+ *       and checks each hit and insert against it, counting any collision and treating it as a miss
+ *   - There are no states to give back, so for_each throws (and MemoStore can't be built from one)
+ */
+template <int N>
+class FingerprintMemo : public MemoBackend<N> {
+public:
+    struct Fingerprint {
+        uint64_t lo;
+        uint64_t hi;
+
+        bool operator==(const Fingerprint& other) const { return lo == other.lo && hi == other.hi; }
+    };
+
+    static Fingerprint fingerprint(const StateBitset<N>& state);
+
+    explicit FingerprintMemo(const Config& c);
+
+    std::optional<SearchResult> get(const StateBitset<N>& state, int depth) override;
+    MemoInsert insert(const StateBitset<N>& state, int depth, const SearchResult& res) override;
+
+    void save(std::ostream& out) const override;
+    void load(std::istream& in) override;
+
+    size_t size() const override { return agnostic_map.size() + specific_map.size(); }
+
+    void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const override;
+
+private:
+    using MemoBackend<N>::MAX_CREDIT;
+    using MemoBackend<N>::initial_credit;
+    using MemoBackend<N>::emplace;
+
+    // 12 bytes of fields, padded to 16. Specific entries leave height at 0
+    struct Entry {
+        double expected_guesses;
+        int16_t best_guess_index;
+        uint8_t max_subtree_height;
+        uint8_t credit;
+    };
+    static_assert(sizeof(Entry) <= 16, "Fingerprint entries have to stay in 16 bytes");
+
+    struct FingerprintHash {
+        size_t operator()(const Fingerprint& f) const noexcept { return f.lo; } // Already well mixed
+    };
+
+    static Fingerprint specific_key(Fingerprint f, int depth) {
+        f.lo ^= static_cast<uint64_t>(depth) * 0x9e3779b97f4a7c15ull;
+        return f;
+    }
+
+    using Map = phmap::parallel_flat_hash_map<
+        Fingerprint,
+        Entry,
+        FingerprintHash,
+        std::equal_to<Fingerprint>,
+        std::allocator<std::pair<const Fingerprint, Entry>>,
+        9,
+        MemoMutex
+    >;
+
+    using VerifyMap = phmap::parallel_flat_hash_map<
+        Fingerprint,
+        StateBitset<N>,
+        FingerprintHash,
+        std::equal_to<Fingerprint>,
+        std::allocator<std::pair<const Fingerprint, StateBitset<N>>>,
+        9,
+        MemoMutex
+    >;
+
+    Map agnostic_map;
+    Map specific_map;
+
+    // Only filled with Config::memo_verify. Never evicted, since it's for checking runs rather than doing them
+    bool verify;
+    VerifyMap verify_map;
+
+    // False (and counted) if state's fingerprint already belongs to another state
+    bool verify_state(const Fingerprint& f, const StateBitset<N>& state, bool claim);
+
+    static constexpr size_t ENTRY_BYTES = sizeof(typename Map::value_type) + 1;
+
+    std::array<size_t, Map::subcnt()> agnostic_hands = {0};
+    std::array<size_t, Map::subcnt()> specific_hands = {0};
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include <cstdint>
+#include <string>
+
+// The hot loops over a LUT row, compiled once per instruction set and picked at startup
+// This way one binary runs on any x86_64 node, but still uses AVX-512 where it has it
+// Both work a word (64 answers, 64 LUT bytes) at a time, so the row needs num_words * 64 readable bytes
+struct Kernels {
+    KernelPath path;
+    const char* name;
+
+    // out[w] = in[w] with only the answers whose row byte is target left on
+    void (*match_pattern)(const uint8_t* row, uint8_t target, const uint64_t* in, uint64_t* out, int num_words);
+
+    // counts[p] += how many of the active answers have pattern p. counts needs NUM_PATTERNS entries
+    void (*count_patterns)(const uint8_t* row, const uint64_t* state, int num_words, int* counts);
+};
+
+// Whether this CPU (and build) can run that path. Auto and Scalar always can
+bool kernel_supported(KernelPath path);
+
+// Auto resolves to the widest supported path. Throws if the CPU can't run the one asked for
+const Kernels& get_kernels(KernelPath path);
+
+KernelPath parse_kernel_path(const std::string& name);
@@ -0,0 +1,69 @@
+#pragma once
+#include "MemoBackend.hpp"
+#include <memory>
+
+/*
+ * Insert-only open-addressing backend with no locks, for when the phmap submap mutexes become the bottleneck
+ *   - Slots are pointers to nodes, and a node is published by CASing it into an empty slot. Nothing is ever
+ *       removed or moved, so a slot only ever goes from empty to its node
+ *   - A node holds the state and the same inline agnostic/specific values as ExactMemo. Each value is claimed,
+ *       written, then published by setting its bit, so a reader only needs acquire loads of the slot and the bits
+ *   - Fixed size: 2^Config::lockfree_slots_log2 slots, or sized from Config::memo_budget_mb if there is one.
+ *       There's no eviction, so once the table is 7/8 full (or the budget is used up) new states are dropped
+ *       and counted as evictions. Memo values are exact, so a dropped state is only solved again
+ *   - Probes step linearly from Fibonacci hashing of the state's FNV hash, since FNV's low bits are weak
+ */
+template <int N>
+class LockFreeMemo : public MemoBackend<N> {
+public:
+    explicit LockFreeMemo(const Config& c);
+    ~LockFreeMemo() override;
+
+    std::optional<SearchResult> get(const StateBitset<N>& state, int depth) override;
+    MemoInsert insert(const StateBitset<N>& state, int depth, const SearchResult& res) override;
+
+    // Same records as ExactMemo, so the dumps are interchangeable
+    void save(std::ostream& out) const override;
+    void load(std::istream& in) override;
+
+    size_t size() const override;
+
+    void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const override;
+
+private:
+    using MemoBackend<N>::budget_bytes;
+    using MemoBackend<N>::used_bytes;
+
+    static constexpr int MAX_DEPTH = 6;
+    static constexpr uint16_t AGNOSTIC_BIT = 1; // Bit d is depth d's specific value
+    static constexpr int PUBLISHED_SHIFT = 8;   // Low byte of bits is claimed values, high byte is published ones
+
+    struct Node {
+        uint64_t hash;
+        StateBitset<N> state;
+        double agnostic_cost;
+        double specific_cost[MAX_DEPTH];
+        int16_t agnostic_guess;
+        int16_t specific_guess[MAX_DEPTH];
+        uint8_t agnostic_height;
+        std::atomic<uint16_t> bits {0};
+    };
+
+    size_t mask; // Slot count minus one
+    size_t max_nodes;
+    std::unique_ptr<std::atomic<Node*>[]> slots;
+    std::atomic<size_t> num_nodes {0};
+
+    // Where state's probe starts
+    size_t home(uint64_t hash) const { return static_cast<size_t>((hash * 0x9e3779b97f4a7c15ull) >> 20) & mask; }
+
+    // The node for state, or null if it isn't in the table
+    const Node* find(const StateBitset<N>& state, uint64_t hash) const;
+
+    // Claims, writes and publishes the value's slot in node. False if another insert already claimed it
+    static bool fill(Node& node, int depth, const SearchResult& result);
+
+    // Published values as (depth, result), with the agnostic one at depth 0
+    template <typename F>
+    static void visit(const Node& node, F&& f);
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include "ClockBudget.hpp"
+#include "Definitions.hpp"
+#include "Wordle.hpp"
+#include <parallel_hashmap/phmap.h>
+#include <array>
+#include <optional>
+
+/*
+ * Admissible lower bounds on what solve_state can return for a state
+ *
+ * There are two kinds:
+ *   - Floors are pure arithmetic on the state size and depth. Every answer costs at least one more guess
+ *     once it's a singleton, so a state with 2+ answers can't be under 2 (or it can only fail if too deep)
+ *   - Partition bounds use the most buckets any single guess can split the state into. Only those buckets
+ *     can be singletons, everything else is stuck in a bucket that costs at least the 2+ floor
+ *     That count is depth independent, so it's cached per state
+ *
+ * On top of those, it keeps the proven bounds of searches that were cut off. Those are exactly as good as
+ * the budget they failed to beat, and they're keyed by depth just like the Specific memo table
+ *
+ * Both caches get an entry per state, so with Config::bound_budget_mb set they're capped by the same CLOCK
+ * eviction as the memo (see ClockBudget.hpp). A dropped entry only means the bound gets worked out again
+ */
+
+template <int N>
+class LowerBound : private ClockBudget {
+public:
+    LowerBound(const Config& c, const Wordle& g);
+
+    // Live estimate of what both caches take up, without locking anything
+    using ClockBudget::memory_bytes;
+
+    double floor(int count, int depth) const;
+    double partition_bound(const StateBitset<N>& state, const GuessBitset& guesses, int depth);
+
+    std::optional<double> get_proven(const StateBitset<N>& state, int depth);
+    void insert_proven(const StateBitset<N>& state, int depth, double bound);
+
+private:
+    int max_buckets(const StateBitset<N>& state, const GuessBitset& guesses);
+
+    struct StateHash {
+        std::size_t operator()(const StateBitset<N>& state) const noexcept {
+            return std::hash<StateBitset<N>>{}(state);
+        }
+    };
+
+    struct ProvenKey {
+        StateBitset<N> state;
+        uint8_t depth;
+
+        bool operator==(const ProvenKey& other) const {
+            return depth == other.depth && state == other.state;
+        }
+    };
+
+    struct ProvenHash {
+        size_t operator()(const ProvenKey& k) const noexcept {
+            size_t h = StateHash{}(k.state);
+            h ^= static_cast<size_t>(k.depth) * 0x9e3779b97f4a7c15ull;
+            return h;
+        }
+    };
+
+    struct BucketEntry {
+        uint8_t buckets;
+        uint8_t credit; // CLOCK credits left before eviction
+    };
+
+    struct ProvenEntry {
+        double bound;
+        uint8_t credit;
+    };
+
+    using BucketMap = phmap::parallel_flat_hash_map<
+        StateBitset<N>,
+        BucketEntry,
+        StateHash,
+        std::equal_to<StateBitset<N>>,
+        std::allocator<std::pair<const StateBitset<N>, BucketEntry>>,
+        9,
+        std::mutex
+    >;
+
+    using ProvenMap = phmap::parallel_flat_hash_map<
+        ProvenKey,
+        ProvenEntry,
+        ProvenHash,
+        std::equal_to<ProvenKey>,
+        std::allocator<std::pair<const ProvenKey, ProvenEntry>>,
+        9,
+        std::mutex
+    >;
+
+    const Config& config;
+    const Wordle& game;
+    BucketMap bucket_map;
+    ProvenMap proven_map;
+
+    // A flat map slot is the pair plus a control byte
+    static constexpr size_t BUCKET_BYTES = sizeof(typename BucketMap::value_type) + 1;
+    static constexpr size_t PROVEN_BYTES = sizeof(typename ProvenMap::value_type) + 1;
+
+    std::array<size_t, BucketMap::subcnt()> bucket_hands = {0}; // Where each submap's last sweep stopped
+    std::array<size_t, ProvenMap::subcnt()> proven_hands = {0};
+};
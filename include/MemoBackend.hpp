@@ -0,0 +1,155 @@
+#pragma once
+#include "ClockBudget.hpp"
+#include "Definitions.hpp"
+#include "Statistics.hpp"
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * What MemoizationTable keeps its entries in. MemoizationTable owns one, picked by Config::memo_backend,
+ * and adds the store tier, stats, and dump header on top
+ *
+ * Every backend follows the same agnostic/specific rules (see ExactMemo.hpp), so they're interchangeable
+ * results-wise, and only differ in what a probe costs and how much an entry takes
+ *
+ * The CLOCK budget (Config::memo_budget_mb) is shared here, since it only needs an entry with a credit field
+ * (see ClockBudget.hpp). Memo values are exact, so eviction only costs the time to solve them again
+ */
+// What a backend insert did with the value
+enum class MemoInsert : uint8_t {
+    Added,   // Stored
+    Present, // Already there (existing entries win), so it was solved twice
+    Dropped  // Not stored and not there, e.g. a full LockFreeMemo. Counted by the backend, not as duplicated work
+};
+
+template <int N>
+class MemoBackend : public ClockBudget {
+public:
+    explicit MemoBackend(const Config& c)
+        : ClockBudget(static_cast<size_t>(c.memo_budget_mb) * 1024 * 1024, &SolverStats::memo_evictions) {}
+    virtual ~MemoBackend() = default;
+
+    virtual std::optional<SearchResult> get(const StateBitset<N>& state, int depth) = 0;
+
+    virtual MemoInsert insert(const StateBitset<N>& state, int depth, const SearchResult& res) = 0;
+
+    // Entries only, MemoizationTable writes the header. Same locking and load semantics as MemoizationTable
+    virtual void save(std::ostream& out) const = 0;
+    virtual void load(std::istream& in) = 0;
+
+    virtual size_t size() const = 0;
+
+    // Throws if this backend doesn't keep the states
+    virtual void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const = 0;
+
+protected:
+    static uint8_t initial_credit(const StateBitset<N>& state) { return ClockBudget::initial_credit(state.count()); }
+};
+
+// -- Dump Helpers --
+// Backends dump as chunks: uint64 count, then that many fixed size records, ending with a 0 count
+
+namespace memo_dump {
+
+// Fields are written one by one, so there's no struct padding in the file
+template <typename T>
+void put(std::vector<char>& buf, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T take(const char*& ptr) {
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return value;
+}
+
+inline void write_chunk(std::ostream& out, uint64_t count, const std::vector<char>& buf) {
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+// Reads a chunk's count and records into buf. False at the end marker
+inline bool read_chunk(std::istream& in, size_t record_size, uint64_t& count, std::vector<char>& buf) {
+    if (!in.read(reinterpret_cast<char*>(&count), sizeof(count)))
+        throw std::runtime_error("Memo dump ends early");
+    if (count == 0) return false;
+
+    buf.resize(count * record_size);
+    if (!in.read(buf.data(), static_cast<std::streamsize>(buf.size())))
+        throw std::runtime_error("Memo dump ends early");
+    return true;
+}
+
+/*
+ * Record layout for the backends that keep whole states (ExactMemo and LockFreeMemo), so their dumps are interchangeable
+ * The agnostic chunks, a 0, the specific chunks, and a 0
+ *   Agnostic record: state words, double cost, int16 guess, uint8 height
+ *   Specific record: state words, uint8 depth, double cost, int16 guess
+ */
+template <int N>
+void put_agnostic(std::vector<char>& buf, const StateBitset<N>& state, double cost, int16_t guess, uint8_t height) {
+    for (uint64_t word : state.words) put(buf, word);
+    put(buf, cost);
+    put(buf, guess);
+    put(buf, height);
+}
+
+template <int N>
+void put_specific(std::vector<char>& buf, const StateBitset<N>& state, uint8_t depth, double cost, int16_t guess) {
+    for (uint64_t word : state.words) put(buf, word);
+    put(buf, depth);
+    put(buf, cost);
+    put(buf, guess);
+}
+
+// Reads both sections, giving each record as (state, depth, result) with agnostic ones at depth 0, like for_each
+template <int N, typename F>
+void read_state_records(std::istream& in, F&& f) {
+    constexpr size_t STATE_BYTES = sizeof(uint64_t) * StateBitset<N>::NUM_WORDS;
+    std::vector<char> buf;
+    uint64_t count;
+
+    auto take_state = [](const char*& ptr) {
+        StateBitset<N> state;
+        std::memcpy(state.words, ptr, STATE_BYTES);
+        ptr += STATE_BYTES;
+        return state;
+    };
+
+    constexpr size_t AGNOSTIC_RECORD = STATE_BYTES + sizeof(double) + sizeof(int16_t) + sizeof(uint8_t);
+    while (read_chunk(in, AGNOSTIC_RECORD, count, buf)) {
+        const char* ptr = buf.data();
+        for (uint64_t r = 0; r < count; ++r) {
+            StateBitset<N> state = take_state(ptr);
+            SearchResult result;
+            result.expected_cost = take<double>(ptr);
+            result.best_guess_index = take<int16_t>(ptr);
+            result.max_height = take<uint8_t>(ptr);
+            f(state, 0, result);
+        }
+    }
+
+    constexpr size_t SPECIFIC_RECORD = STATE_BYTES + sizeof(uint8_t) + sizeof(double) + sizeof(int16_t);
+    while (read_chunk(in, SPECIFIC_RECORD, count, buf)) {
+        const char* ptr = buf.data();
+        for (uint64_t r = 0; r < count; ++r) {
+            StateBitset<N> state = take_state(ptr);
+            int depth = take<uint8_t>(ptr);
+            SearchResult result;
+            result.expected_cost = take<double>(ptr);
+            result.best_guess_index = take<int16_t>(ptr);
+            result.max_height = 7 - depth;
+            f(state, depth, result);
+        }
+    }
+}
+
+} // namespace memo_dump
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "Wordle.hpp"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+
+template <int N>
+class MemoizationTable;
+
+/*
+ * Read-only memo on disk, used as a second tier behind MemoizationTable's maps for warm starts
+ * The file is two open-addressing tables of fixed size records (same agnostic/specific split as MemoizationTable),
+ * and it's mmapped, so lookups read straight out of the page cache and opening it costs nothing up front
+ * Built by write() (or the WordleMemoMerge tool) from a table, usually a finished run's checkpoint
+ */
+template <int N>
+class MemoStore {
+public:
+    // Throws if the file is missing, malformed, or from other word lists
+    MemoStore(const std::string& path, const Wordle& game);
+    ~MemoStore();
+
+    MemoStore(const MemoStore&) = delete;
+    MemoStore& operator=(const MemoStore&) = delete;
+
+    // Same rules as MemoizationTable::get
+    std::optional<SearchResult> get(const StateBitset<N>& state, int depth) const;
+
+    // Every entry, in the same (state, depth, result) form MemoizationTable::for_each gives
+    void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const;
+
+    size_t size() const { return num_entries; }
+
+    // Writes everything in table as a store at path (temp file and rename)
+    static void write(const std::string& path, const Wordle& game, const MemoizationTable<N>& table);
+
+private:
+    struct AgnosticRecord {
+        uint64_t words[StateBitset<N>::NUM_WORDS];
+        double expected_guesses;
+        int16_t best_guess_index;
+        uint8_t max_subtree_height;
+        uint8_t used;
+    };
+
+    struct SpecificRecord {
+        uint64_t words[StateBitset<N>::NUM_WORDS];
+        double expected_guesses;
+        int16_t best_guess_index;
+        uint8_t depth;
+        uint8_t used;
+    };
+
+    struct Header;
+
+    static size_t agnostic_hash(const StateBitset<N>& state) { return std::hash<StateBitset<N>>{}(state); }
+    static size_t specific_hash(const StateBitset<N>& state, int depth) {
+        return agnostic_hash(state) ^ (static_cast<size_t>(depth) * 0x9e3779b97f4a7c15ull); // Same as the SpecificMap
+    }
+
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    const AgnosticRecord* agnostic = nullptr;
+    const SpecificRecord* specific = nullptr;
+    size_t agnostic_mask = 0; // Slots - 1, slots are a power of 2
+    size_t specific_mask = 0;
+    size_t num_entries = 0;
+};
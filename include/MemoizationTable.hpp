@@ -1,102 +1,102 @@
 #pragma once
 #include "Definitions.hpp"
-// #include "Statistics.hpp"
+#include "MemoBackend.hpp"
+#include "MemoStore.hpp"
+#include "Profile.hpp"
 #include <parallel_hashmap/phmap.h>
+#include <functional>
+#include <istream>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <string>
 
 /*
- * Outwardly, this behaves as a single table. Interally, it has two
- * The Agnostic table:
- *   - Can only work when the final value was untainted by going past 6 guesses
- *   - Stores the values and how far down the subtree it had to go to get them
- *   - In getting, if the get callee is far enough up that the subtree wouldn't reach 7
- *       then it's able to use that value, because it wouldn't ever hit fail
- * The Specific table:
- *   - Stores tainted final values (moved by the fail value)
- *   - Just stores the final value, but the key is state AND depth
- *   - This is the failover when it can't be added or found in the Agnostic table
- *   - Likely mostly stores the small states, since they're the most likely to use a fail value
+ * Outwardly, this behaves as a single table. The entries live in a backend picked by Config::memo_backend
+ *   - Exact (ExactMemo.hpp): keyed on whole states, the agnostic/specific split is explained there
+ *   - Fingerprint (FingerprintMemo.hpp): keyed on 128 bit fingerprints, about a tenth of the memory
+ *   - LockFree (LockFreeMemo.hpp): whole states in a fixed size insert-only table, with no locks to fight over
+ * Behind the backend there's an optional read-only MemoStore, checked when the backend misses
  *
- * It has to be done like this for two reasons
- * 1. Cached values must know their depth
- *      If we tried without it, then the 1e9 value assigned to a bitset at depth 6 is the same as that one at depth 2
- * 2. That was way too slow, and resulted in a 50x cache miss rate
- *      This method gets it much closer to no-depth with around 5x the miss rate
+ * With Config::memo_budget_mb set, the backend is capped by evicting with CLOCK (see MemoBackend.hpp)
  */
 
+// For --memo-backend. parse throws on an unknown name
+MemoBackendType parse_memo_backend(const std::string& name);
+std::string memo_backend_name(MemoBackendType type);
+
+// For --claims (off, wait, help or defer). Throws on an unknown name
+ClaimPolicy parse_claim_policy(const std::string& name);
+
+template <int N>
 class MemoizationTable {
 public:
     MemoizationTable(const Config& c);
 
-    std::optional<SearchResult> get(const StateBitset& state, int depth);
-    void insert(const StateBitset& state, int depth, const SearchResult& res);
-private:
-    // -- Agnostic Map Structs --
+    std::optional<SearchResult> get(const StateBitset<N>& state, int depth);
+    void insert(const StateBitset<N>& state, int depth, const SearchResult& res);
 
-    struct AgnosticEntry {
-        double expected_guesses;
-        int16_t best_guess_index;
-        uint8_t max_subtree_height;
-    };
+    // Binary dump of the backend. Each submap is only locked while it's copied, so workers can keep going
+    // Entries are exact, so whatever lands in the dump (before or after a concurrent insert) is still valid
+    void save(std::ostream& out) const;
 
-    using AgnosticKey = StateBitset;
+    // Adds the entries of a save on top of what's here. Existing entries win, same as insert
+    // Throws if it's malformed or from a backend with other records (exact and lock-free dumps are the same)
+    void load(std::istream& in);
 
-    struct AgnosticHash {
-        std::size_t operator()(const StateBitset& state) const noexcept {
-            return std::hash<StateBitset>{}(state);
-        }
-    };
+    size_t size() const { return backend->size(); }
 
+    // Every entry as (state, depth, result), in a form insert takes back. Agnostic entries come out at depth 0
+    // Throws on the fingerprint backend, which doesn't keep states
+    void for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const {
+        backend->for_each(f);
+    }
 
-    // -- Specific Map Structs --
+    // Read-only second tier, checked when the backend misses. Has to outlive the table
+    void attach_store(const MemoStore<N>* s) { store = s; }
 
-    struct SpecificEntry {
-        double expected_guesses;
-        int16_t best_guess_index;
-    };
+    // Live estimate of what the entries take up (slots and control bytes), without locking anything
+    size_t memory_bytes() const { return backend->memory_bytes(); }
 
-    struct SpecificKey {
-        StateBitset state;
+    // -- In-flight Claims --
+    // The first thread to miss on a state claims it while solving, so the others can wait for it or work around it
+    // Keyed on a hash rather than the state, since only states being solved right now are in here
+    //   A hash collision only costs a needless wait, the memo itself stays exact
+
+    // True if this thread now owns the claim. Release it after inserting the result, so waiters find it
+    bool try_claim(const StateBitset<N>& state, int depth);
+    void release_claim(const StateBitset<N>& state, int depth);
+    bool is_claimed(const StateBitset<N>& state, int depth) const;
+private:
+    const Config& config;
+    std::unique_ptr<MemoBackend<N>> backend;
+    const MemoStore<N>* store = nullptr;
+
+    struct ClaimKey {
+        uint64_t hash;
         uint8_t depth;
 
-        bool operator==(const SpecificKey& other) const {
-            return depth == other.depth && state == other.state;
-        }
+        bool operator==(const ClaimKey& other) const { return hash == other.hash && depth == other.depth; }
     };
 
-    struct SpecificHash {
-        size_t operator()(const SpecificKey& k) const noexcept {
-            size_t h = AgnosticHash{}(k.state);
-            h ^= static_cast<size_t>(k.depth) * 0x9e3779b97f4a7c15ull;
-            return h;
-        }
+    struct ClaimHash {
+        size_t operator()(const ClaimKey& k) const noexcept { return k.hash ^ (static_cast<size_t>(k.depth) * 0x9e3779b97f4a7c15ull); }
     };
 
-    // -- Maps Setup --
-
-    using AgnosticMap = phmap::parallel_flat_hash_map<
-        AgnosticKey,
-        AgnosticEntry,
-        AgnosticHash,
-        std::equal_to<StateBitset>,
-        std::allocator<std::pair<const StateBitset, AgnosticEntry>>,
-        9, // Means 2^9 strips
-        std::mutex
+    static ClaimKey claim_key(const StateBitset<N>& state, int depth) {
+        return ClaimKey{ std::hash<StateBitset<N>>{}(state), static_cast<uint8_t>(depth) };
+    }
+
+    // Value is the owning OpenMP thread, for debugging
+    using ClaimMap = phmap::parallel_flat_hash_map<
+        ClaimKey,
+        int,
+        ClaimHash,
+        std::equal_to<ClaimKey>,
+        std::allocator<std::pair<const ClaimKey, int>>,
+        6, // Only a handful of states per thread at a time
+        MemoMutex
     >;
 
-    using SpecificMap = phmap::parallel_flat_hash_map<
-        SpecificKey,
-        SpecificEntry,
-        SpecificHash,
-        std::equal_to<SpecificKey>,
-        std::allocator<std::pair<const SpecificKey, SpecificEntry>>,
-        9,
-        std::mutex
-    >;
-
-    // -- Map Objects --
-
-    const Config& config;
-    AgnosticMap agnostic_map;
-    SpecificMap specific_map;
+    ClaimMap claims;
 };
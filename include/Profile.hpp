@@ -0,0 +1,122 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+/*
+ * Where the time goes, for builds configured with -DWORDLE_PROFILE=ON. Otherwise every hook here compiles to nothing
+ *   - PROFILE_SCOPE(phase, depth) times the rest of its scope with rdtsc, into the thread's own t_profile (like t_stats)
+ *   - Each phase is split by depth, since the same phase costs very different amounts near the root and the leaves
+ *   - The memo's submaps lock through MemoMutex, which also times every wait for a lock someone else held
+ *   - main folds t_profile into g_profile wherever it folds t_stats, and prints the report at exit
+ * Phases can nest (a memo get's lock wait is inside the get), so the totals add up to more than the run
+ */
+
+enum class Phase : uint8_t {
+    PruneActions,   // Solver::prune_actions
+    OrderGuesses,   // The count_patterns loop scoring guesses in order_guesses
+    Partition,      // partition_state in evaluate_guess
+    PartitionBound, // LowerBound::partition_bound, both in evaluate_guess and solve_state
+    SmallSolve,     // solve_small, from solve_state
+    MemoGet,
+    MemoInsert,
+    COUNT
+};
+
+#ifdef WORDLE_PROFILE
+
+#include <x86intrin.h>
+
+struct PhaseProfile {
+    static constexpr int NUM_PHASES = static_cast<int>(Phase::COUNT);
+    static constexpr int NUM_DEPTHS = 8; // 0 to 7, deeper is counted as 7
+    static constexpr int NUM_WAIT_BUCKETS = 32; // Bucket b is waits of 2^b to 2^(b+1) cycles
+
+    std::array<std::array<uint64_t, NUM_DEPTHS>, NUM_PHASES> cycles {};
+    std::array<std::array<uint64_t, NUM_DEPTHS>, NUM_PHASES> calls {};
+    std::array<uint64_t, NUM_WAIT_BUCKETS> lock_waits {};
+    uint64_t lock_wait_cycles = 0;
+    uint64_t uncontended_locks = 0;
+
+    void add(Phase phase, int depth, uint64_t elapsed) {
+        int d = depth < 0 ? 0 : (depth >= NUM_DEPTHS ? NUM_DEPTHS - 1 : depth);
+        cycles[static_cast<int>(phase)][d] += elapsed;
+        calls[static_cast<int>(phase)][d]++;
+    }
+
+    void add_lock_wait(uint64_t elapsed) {
+        int bucket = elapsed == 0 ? 0 : 63 - __builtin_clzll(elapsed);
+        lock_waits[bucket < NUM_WAIT_BUCKETS ? bucket : NUM_WAIT_BUCKETS - 1]++;
+        lock_wait_cycles += elapsed;
+    }
+
+    void operator+=(const PhaseProfile& other);
+
+    // Cycles are turned into time with the TSC rate measured over the whole run
+    void print() const;
+};
+
+extern thread_local PhaseProfile t_profile;
+extern PhaseProfile g_profile;
+
+class ScopedTimer {
+public:
+    ScopedTimer(Phase p, int d) : phase(p), depth(d), start(__rdtsc()) {}
+    ~ScopedTimer() { t_profile.add(phase, depth, __rdtsc() - start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Phase phase;
+    int depth;
+    uint64_t start;
+};
+
+// A std::mutex that times the lock calls it had to wait on. The uncontended path is one try_lock
+// Has the shared calls as well, for phmap's read locks (they're exclusive, same as std::mutex gets)
+class ProfiledMutex {
+public:
+    void lock() {
+        if (mutex.try_lock()) {
+            t_profile.uncontended_locks++;
+            return;
+        }
+        uint64_t start = __rdtsc();
+        mutex.lock();
+        t_profile.add_lock_wait(__rdtsc() - start);
+    }
+    bool try_lock() { return mutex.try_lock(); }
+    void unlock() { mutex.unlock(); }
+
+    void lock_shared() { lock(); }
+    bool try_lock_shared() { return try_lock(); }
+    void unlock_shared() { unlock(); }
+
+private:
+    std::mutex mutex;
+};
+
+using MemoMutex = ProfiledMutex;
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase, depth) ScopedTimer PROFILE_CONCAT(profile_timer_, __LINE__)(phase, depth)
+
+// Call where t_stats is merged (so under the same critical section)
+inline void profile_collect() {
+    g_profile += t_profile;
+    t_profile = PhaseProfile();
+}
+inline void profile_report() { g_profile.print(); }
+
+#else
+
+using MemoMutex = std::mutex;
+
+#define PROFILE_SCOPE(phase, depth) ((void)0)
+
+inline void profile_collect() {}
+inline void profile_report() {}
+
+#endif
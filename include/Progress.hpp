@@ -0,0 +1,106 @@
+#pragma once
+#include "Definitions.hpp"
+#include "Statistics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * Live progress for long runs, from a background thread that never makes the workers wait on it
+ *   - Each worker has its own cache line shard of running totals, which only it writes (relaxed stores)
+ *   - Workers publish their t_stats into it every PUBLISH_EVERY nodes, and whenever t_stats is reset
+ *   - Every Config::stats_print_freq seconds the reporter sums the shards (relaxed loads) and prints a line with
+ *       nodes/s, hit rate, memo and bound cache sizes, openers done and an ETA, plus a JSON line to Config::progress_json_path
+ * The numbers can be a few thousand nodes behind, which is fine for watching a run
+ */
+
+// Resident set size from /proc, so memory is reported as the cluster sees it. 0 where that's not available
+size_t current_rss_bytes();
+
+struct alignas(64) ProgressShard {
+    std::atomic<long> nodes {0};
+    std::atomic<long> cache_hits {0};
+    std::atomic<long> cache_misses {0};
+};
+
+// This thread's shard and what it had already folded in. Null shard when there's no reporter
+struct ProgressLink {
+    ProgressShard* shard = nullptr;
+    long base_nodes = 0;
+    long base_hits = 0;
+    long base_misses = 0;
+};
+extern thread_local ProgressLink t_progress;
+
+constexpr long PUBLISH_EVERY = 4096; // Nodes between a worker's publishes. Power of 2
+
+// Copies this thread's t_stats into its shard
+inline void publish_progress() {
+    ProgressLink& link = t_progress;
+    if (!link.shard) return;
+    link.shard->nodes.store(link.base_nodes + t_stats.nodes_visited, std::memory_order_relaxed);
+    link.shard->cache_hits.store(link.base_hits + t_stats.cache_hits, std::memory_order_relaxed);
+    link.shard->cache_misses.store(link.base_misses + t_stats.cache_misses, std::memory_order_relaxed);
+}
+
+// Right before t_stats is reset, so the shard keeps counting from where it was
+inline void fold_progress() {
+    publish_progress();
+    t_progress.base_nodes += t_stats.nodes_visited;
+    t_progress.base_hits += t_stats.cache_hits;
+    t_progress.base_misses += t_stats.cache_misses;
+}
+
+class ProgressReporter {
+public:
+    // num_tickets is how many openers this run has to get through, 0 if it isn't known (no ETA then)
+    // memo_bytes and bound_bytes are polled for the memo and LowerBound cache sizes, so they mustn't lock anything
+    // rank tags the lines of one MPI rank, -1 outside WordleSolverMPI
+    ProgressReporter(const Config& c, int num_tickets, std::function<size_t()> memo_bytes, std::function<size_t()> bound_bytes,
+                     int rank = -1);
+    ~ProgressReporter() { stop(); }
+
+    // Every worker, inside the parallel region, before it solves anything. Detach before the region ends
+    void attach(int thread_num);
+    static void detach() { t_progress = ProgressLink(); }
+
+    // An opener finished. Any thread
+    void ticket_done() { tickets_done.fetch_add(1, std::memory_order_relaxed); }
+
+    // Starts reporting. Does nothing if Config::stats_print_freq is 0
+    void start();
+
+    // Stops the thread, after one last report
+    void stop();
+
+private:
+    const Config& config;
+    int num_tickets;
+    std::function<size_t()> memo_bytes;
+    std::function<size_t()> bound_bytes;
+    int rank;
+
+    std::unique_ptr<ProgressShard[]> shards;
+    int num_shards;
+    std::atomic<int> tickets_done {0};
+
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point last_time;
+    long last_nodes = 0;
+
+    std::ofstream json;
+    std::thread thread;
+    std::mutex stop_mutex;
+    std::condition_variable stop_signal;
+    bool stopping = false;
+
+    void run();
+    void report();
+};
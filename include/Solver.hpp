@@ -5,20 +5,75 @@
 #include "Wordle.hpp"
 #include "Definitions.hpp"
 #include "MemoizationTable.hpp"
+#include "LowerBound.hpp"
+#include <array>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
 
+template <int N>
 class Solver {
     const Config& config;
     const Wordle& game;
-    MemoizationTable& cache;
+    MemoizationTable<N>& cache;
+    LowerBound<N>& bounds;
+    const std::atomic<double>* root_budget = nullptr;
 
 public:
-    Solver(const Config& c, const Wordle& g, MemoizationTable& m);
+    Solver(const Config& c, const Wordle& g, MemoizationTable<N>& m, LowerBound<N>& b);
 
-    SearchResult evaluate_guess(const StateBitset& state, int guess_ind, const GuessBitset& useful_guesses, int depth);
+    // If the guess provably costs more than budget, returns early with is_cut set and a lower bound as the cost
+    SearchResult evaluate_guess(const StateBitset<N>& state, int guess_ind, const GuessBitset& useful_guesses, int depth,
+                                double budget = NO_BUDGET);
+
+    // Openers (evaluate_guess at depth 1) also get cut once they can't beat *budget, which other threads can lower
+    // while they run. Null for none
+    void share_root_budget(const std::atomic<double>* budget) { root_budget = budget; }
+
+    // One guess per class of curr_guesses that split state the same way, dropping any that don't split it at all
+    // (or, with Config::dominance, that another guess splits further)
+    // Keeps the lowest index of each class. Children are handed these, so a duplicate is never seen twice
+    // Written into useful_guesses, which is solve_state's scratch rather than a fresh 1.6 KB bitset to return
+    // Public so WordleBench can time it on its own
+    void prune_actions(const StateBitset<N>& state, const GuessBitset& curr_guesses, GuessBitset& useful_guesses);
 
 private:
-    // The actual internal recursion
-    SearchResult solve_state(const StateBitset& state, const GuessBitset& useful_guesses, int depth);
+    // The actual internal recursion. Only returns a cut result when given a budget (deep_cutoffs)
+    SearchResult solve_state(const StateBitset<N>& state, const GuessBitset& useful_guesses, int depth,
+                             double budget = NO_BUDGET);
+
+    // evaluate_guess's bucket loop, but with the big buckets as OpenMP tasks. Same result, just joined after a taskwait
+    SearchResult evaluate_tasks(const Partition<N>& partition, int active_count, int guess_ind, const GuessBitset& useful_guesses,
+                                int depth, const std::array<double, NUM_PATTERNS>& bucket_floor, double floor_total, double cost_limit);
+
+    static constexpr int MAX_SMALL_STATE = 5; // Partition keys pack 3 bits per answer, and Bell(5) of them fit solve_small's list
+
+    // Exact solve_state for the states up to Config::small_state_max, straight off the LUT with no memo
+    // answers is the state as a list. Same cost as the general recursion, but it stops at the first guess
+    // that makes every answer a singleton (nothing can beat that), and only tries each distinct partition once
+    SearchResult solve_small(const int* answers, int count, const GuessBitset& guesses, int depth);
+
+    // cost_limit, tightened to the shared root budget if depth is an opener's
+    double root_limit(double cost_limit, int active_count, int depth) const;
 
-    GuessBitset prune_actions(const StateBitset& state, const GuessBitset& curr_guesses);
+    // Waits out another thread's claim on state, then reads its result from the memo (if it made it there)
+    std::optional<SearchResult> await_claim(const StateBitset<N>& state, int depth);
+
+    struct Representative {
+        int num_buckets;
+        int guess_index;
+    };
+
+    // prune_actions' last stage under Config::dominance: drops the guesses another one's partition refines
+    void drop_dominated(const std::vector<int>& active_indices, std::vector<Representative>& representatives);
+
+    // Reorders guess_inds by Config::guess_order so the likely best are searched first
+    void order_guesses(const StateBitset<N>& state, std::vector<int>& guess_inds);
 };
+
+// off, approx or exact, for --dominance
+DominancePolicy parse_dominance_policy(const std::string& name);
+
+// index, buckets, largest or entropy, for --guess-order
+GuessOrder parse_guess_order(const std::string& name);
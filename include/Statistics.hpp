@@ -9,38 +9,69 @@ struct SolverStats {
     long cache_hits = 0;
     long cache_misses = 0;
     long nodes_visited = 0;
+    long small_solves = 0; // States handed to the small state engine instead of the memo
     long prune_function_calls = 0;
     long total_actions_checked = 0;
     long total_actions_kept = 0;
     long useless_pruned = 0;
     long duplicates_pruned = 0;
+    long dominated_pruned = 0; // Guesses another guess's partition refines
+    long dominance_checks = 0; // Pairs compared answer by answer
     long memo_inserts = 0;
     long memo_collisions = 0; // Duplicated work
+    long store_hits = 0; // Misses in memory that the on-disk store had
+    long memo_evictions = 0; // Entries dropped to stay in the memory budget
+    long fingerprint_collisions = 0; // Only counted with Config::memo_verify
+    long cutoffs = 0; // Guesses abandoned by branch and bound
+    long bounds_computed = 0; // Partition bounds that had to scan the guesses
+    long bound_cache_hits = 0;
+    long bound_prunes = 0; // States cut off by a bound without searching them
+    long proven_inserts = 0;
+    long bound_evictions = 0; // Bucket and proven entries dropped to stay in the bound budget
+    long tasks_split = 0; // evaluate_guess calls that handed their buckets out as tasks
+    long claim_waits = 0; // States another thread was already solving, read from the memo once it finished
+    long claim_defers = 0; // Buckets pushed to the back of evaluate_guess because they were in flight
 
     // Helper to merge another thread's stats into this one
     void operator+=(const SolverStats& other) {
         cache_hits += other.cache_hits;
         cache_misses += other.cache_misses;
         nodes_visited += other.nodes_visited;
+        small_solves += other.small_solves;
         prune_function_calls += other.prune_function_calls;
         total_actions_checked += other.total_actions_checked;
         total_actions_kept += other.total_actions_kept;
         useless_pruned += other.useless_pruned;
         duplicates_pruned += other.duplicates_pruned;
+        dominated_pruned += other.dominated_pruned;
+        dominance_checks += other.dominance_checks;
         memo_inserts += other.memo_inserts;
         memo_collisions += other.memo_collisions;
+        store_hits += other.store_hits;
+        memo_evictions += other.memo_evictions;
+        fingerprint_collisions += other.fingerprint_collisions;
+        cutoffs += other.cutoffs;
+        bounds_computed += other.bounds_computed;
+        bound_cache_hits += other.bound_cache_hits;
+        bound_prunes += other.bound_prunes;
+        proven_inserts += other.proven_inserts;
+        bound_evictions += other.bound_evictions;
+        tasks_split += other.tasks_split;
+        claim_waits += other.claim_waits;
+        claim_defers += other.claim_defers;
     }
 
     void print() {
         long total_reqs = cache_hits + cache_misses;
         double hit_rate = total_reqs > 0 ? (100.0 * cache_hits / total_reqs) : 0.0;
-        long pruned_count = useless_pruned + duplicates_pruned;
+        long pruned_count = useless_pruned + duplicates_pruned + dominated_pruned;
         long total_prune_ops = total_actions_checked > 0 ? total_actions_checked : 1;
         double prune_rate = 100.0 * pruned_count / total_prune_ops;
         double collision_rate = memo_inserts > 0 ? (100.0 * memo_collisions / memo_inserts) : 0.0;
 
         std::cout << "\n=== SOLVER STATISTICS ===\n";
         std::cout << "Nodes Visited:   " << nodes_visited << "\n";
+        std::cout << "Small Solves:    " << small_solves << "\n";
         std::cout << "Cache Hit Rate:  " << std::fixed << std::setprecision(2) << hit_rate << "% (" 
                   << cache_hits << " hits / " << cache_misses << " misses)\n";
         std::cout << "-------------------------\n";
@@ -48,9 +79,26 @@ struct SolverStats {
         std::cout << "  - Inserts:     " << memo_inserts << "\n";
         std::cout << "  - Collisions:  " << memo_collisions << "\n";
         std::cout << "  - Redundancy:  " << collision_rate << "% (Lower is better)\n";
+        std::cout << "  - Store Hits:  " << store_hits << "\n";
+        std::cout << "  - Evictions:   " << memo_evictions << "\n";
+        std::cout << "  - FP Collisions:" << fingerprint_collisions << "\n";
         std::cout << "-------------------------\n";
         std::cout << "Pruning Calls:   " << prune_function_calls << "\n";
         std::cout << "Prune Rate:      " << prune_rate << "%\n";
+        std::cout << "  - Useless:     " << useless_pruned << "\n";
+        std::cout << "  - Duplicates:  " << duplicates_pruned << "\n";
+        std::cout << "  - Dominated:   " << dominated_pruned << " (" << dominance_checks << " checks)\n";
+        std::cout << "Cutoffs:         " << cutoffs << "\n";
+        std::cout << "Task Splits:     " << tasks_split << "\n";
+        std::cout << "Claim Waits:     " << claim_waits << "\n";
+        std::cout << "Claim Defers:    " << claim_defers << "\n";
+        std::cout << "-------------------------\n";
+        std::cout << "Lower Bounds:\n";
+        std::cout << "  - Computed:    " << bounds_computed << "\n";
+        std::cout << "  - Cache Hits:  " << bound_cache_hits << "\n";
+        std::cout << "  - State Prunes:" << bound_prunes << "\n";
+        std::cout << "  - Proven:      " << proven_inserts << "\n";
+        std::cout << "  - Evictions:   " << bound_evictions << "\n";
         std::cout << "=========================\n";    }
 };
 
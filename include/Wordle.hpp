@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Definitions.hpp"
+#include "Kernels.hpp"
+#include <array>
 #include <vector>
 #include <string>
 
@@ -12,12 +14,25 @@ enum class Color : uint8_t {
     Green = 2
 };
 
+// Every child state of one guess. Only the first num_patterns entries of patterns are valid (ascending)
+// Meant to be reused, partition_state only clears the buckets it used last time
+template <int N>
+struct Partition {
+    std::array<StateBitset<N>, NUM_PATTERNS> buckets;
+    std::array<int, NUM_PATTERNS> counts = {0};
+    std::array<Pattern, NUM_PATTERNS> patterns;
+    int num_patterns = 0;
+    int first_word = 0, last_word = -1; // Words the last state used, so only those need clearing in the buckets
+};
+
 class Wordle {
 private:
     const Config& config;
     std::vector<std::string> answers;
     std::vector<std::string> guesses;
     std::vector<uint8_t> pattern_lut;
+    int row_stride; // Answers per LUT row, rounded up to whole 64 bit words
+    const Kernels* kernels; // Picked for this CPU when the game is made
 
 public:
     Wordle(const Config& c);
@@ -26,11 +41,27 @@ public:
     static Pattern compute_pattern(const std::string& guess, const std::string& target);
 
     Pattern get_pattern_lookup(int guess_index, int answer_index) const {
-        return pattern_lut[guess_index * NUM_ANSWERS + answer_index];
+        return pattern_lut[guess_index * row_stride + answer_index];
     }
 
-    const StateBitset prune_state(const StateBitset& current, int guess_index, Pattern target_pattern) const;
+    template <int N>
+    const StateBitset<N> prune_state(const StateBitset<N>& current, int guess_index, Pattern target_pattern) const;
+
+    // counts[p] = how many answers in current would give pattern p for this guess
+    template <int N>
+    void count_patterns(const StateBitset<N>& current, int guess_index, std::array<int, NUM_PATTERNS>& counts) const;
+
+    // Same result as prune_state on every pattern, but in a single pass over the state
+    template <int N>
+    void partition_state(const StateBitset<N>& current, int guess_index, Partition<N>& out) const;
+
+    int num_answers() const { return static_cast<int>(answers.size()); }
+    int num_guesses() const { return static_cast<int>(guesses.size()); }
 
     const std::string& get_guess_str(int index) const { return guesses[index]; }
     const std::string& get_answer_str(int index) const { return answers[index]; }
+    const Kernels& active_kernels() const { return *kernels; }
+
+    // Identifies the answers and guesses (in order), since anything saved to disk is keyed on their indices
+    uint64_t word_list_hash() const;
 };
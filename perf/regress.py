@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+End-to-end performance regression check for WordleSolver
+
+Runs the solver on a few fixed workloads and compares each against the last run of it in perf/history.jsonl
+(from this machine, and from another commit if there is one). Fails if
+  - the best opener or its cost changed at all
+  - wall time, nodes visited or peak RSS grew by more than --tolerance
+  - the cache hit rate dropped by more than --hit-tolerance points
+With --record, passing results are appended to the history, keyed by commit. gen_graph.py plots from it
+
+    ./perf/regress.py                       # Check against the history
+    ./perf/regress.py --record              # Check, then add this commit's results
+    ./perf/regress.py --workload sample     # Just one of them
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import socket
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA = os.path.join(ROOT, "data")
+
+
+def every_nth(words, n):
+    return words[::n]
+
+
+def read_words(name):
+    with open(os.path.join(DATA, name)) as f:
+        return [line.strip() for line in f if line.strip()]
+
+
+# Each workload is its word lists (made from data/ the same way every time) and any extra flags
+def sample_lists():
+    answers = every_nth(read_words("answers.txt"), 8)
+    keep = set(answers)
+    guesses = [w for i, w in enumerate(read_words("guesses.txt")) if i % 20 == 0 or w in keep]
+    return answers, guesses
+
+
+WORKLOADS = {
+    # What performance_graph.png has always tracked
+    "small": {
+        "about": "50 answers, full guesses",
+        "lists": lambda: (read_words("answers_small.txt"), read_words("guesses.txt")),
+        "flags": [],
+    },
+    # Every 8th answer, with every 20th guess (and the answers) to guess with. Every opener
+    "sample": {
+        "about": "290 answers, 923 guesses",
+        "lists": sample_lists,
+        "flags": [],
+    },
+    # Every 4th answer and every guess, but only the openers in perf/openers.txt
+    "openers": {
+        "about": "579 answers, full guesses, 5 openers",
+        "lists": lambda: (every_nth(read_words("answers.txt"), 4), read_words("guesses.txt")),
+        "flags": ["--openers", os.path.join(ROOT, "perf", "openers.txt")],
+    },
+}
+
+METRICS = ["wall_s", "nodes", "peak_rss_mb"]  # Lower is better, held to --tolerance
+
+
+def write_lists(name, out_dir):
+    answers, guesses = WORKLOADS[name]["lists"]()
+    paths = []
+    for kind, words in (("answers", answers), ("guesses", guesses)):
+        path = os.path.join(out_dir, f"{name}_{kind}.txt")
+        with open(path, "w") as f:
+            f.write("\n".join(words) + "\n")
+        paths.append(path)
+    return paths
+
+
+def run_once(solver, name, answers, guesses):
+    cmd = [solver, "--answers", answers, "--guesses", guesses] + WORKLOADS[name]["flags"]
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    output = proc.stdout.read()
+    _, status, usage = os.wait4(proc.pid, 0)  # This child's own rusage, for its peak RSS
+    wall = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        sys.exit(f"{name}: {' '.join(cmd)} exited with {proc.returncode}\n{output[-2000:]}")
+
+    def find(pattern):
+        match = re.search(pattern, output)
+        if not match:
+            sys.exit(f"{name}: couldn't find /{pattern}/ in the solver's output")
+        return match.groups()
+
+    best, cost = find(r"Best opener is (\S+) at (\S+) expected guesses")
+    return {
+        "best": best,
+        "cost": float(cost),
+        "wall_s": round(wall, 3),
+        "nodes": int(find(r"Nodes Visited:\s+(\d+)")[0]),
+        "hit_rate": float(find(r"Cache Hit Rate:\s+([\d.]+)%")[0]),
+        "peak_rss_mb": round(usage.ru_maxrss / 1024, 1),  # ru_maxrss is in KB on Linux
+    }
+
+
+# The fastest of the runs, since anything slower is noise from the rest of the machine
+def run_workload(solver, name, runs, out_dir):
+    answers, guesses = write_lists(name, out_dir)
+    results = [run_once(solver, name, answers, guesses) for _ in range(runs)]
+    if len({(r["best"], r["cost"]) for r in results}) != 1:
+        sys.exit(f"{name}: runs disagree on the best opener: {[(r['best'], r['cost']) for r in results]}")
+    fastest = min(results, key=lambda r: r["wall_s"])
+    fastest["peak_rss_mb"] = max(r["peak_rss_mb"] for r in results)
+    return fastest
+
+
+def git(*args):
+    return subprocess.run(["git", "-C", ROOT] + list(args), capture_output=True, text=True).stdout.strip()
+
+
+def load_history(path):
+    if not os.path.exists(path):
+        return []
+    with open(path) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def baseline(history, name, host, commit):
+    same = [e for e in history if e.get("workload") == name and e.get("host") == host]
+    older = [e for e in same if e.get("commit") != commit]
+    return (older or same or [None])[-1]
+
+
+def compare(name, result, base, args):
+    failures = []
+    if (result["best"], result["cost"]) != (base["best"], base["cost"]):
+        failures.append(f"best opener {result['best']} at {result['cost']}, was {base['best']} at {base['cost']}")
+    for metric in METRICS:
+        if base.get(metric) and result[metric] > base[metric] * (1 + args.tolerance):
+            failures.append(f"{metric} {result[metric]}, was {base[metric]} (+{result[metric] / base[metric] - 1:.0%})")
+    if base.get("hit_rate") is not None and result["hit_rate"] < base["hit_rate"] - args.hit_tolerance:
+        failures.append(f"hit_rate {result['hit_rate']}%, was {base['hit_rate']}%")
+    return [f"{name}: {f}" for f in failures]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="WordleSolver performance regression check")
+    parser.add_argument("--build", default=os.path.join(ROOT, "build"), help="Build directory with WordleSolver")
+    parser.add_argument("--workload", action="append", choices=sorted(WORKLOADS), help="Only these (repeatable)")
+    parser.add_argument("--runs", type=int, default=3, help="Runs per workload, the fastest counts")
+    parser.add_argument("--tolerance", type=float, default=0.15, help="Allowed growth in time, nodes and RSS")
+    parser.add_argument("--hit-tolerance", type=float, default=2.0, help="Allowed drop in cache hit rate (points)")
+    parser.add_argument("--history", default=os.path.join(ROOT, "perf", "history.jsonl"))
+    parser.add_argument("--record", action="store_true", help="Append passing results to the history")
+    parser.add_argument("--force", action="store_true", help="With --record, append even if the check fails")
+    parser.add_argument("--label", default=None, help="Label for the graph, defaults to the commit subject")
+    args = parser.parse_args()
+
+    solver = os.path.join(args.build, "WordleSolver")
+    if not os.access(solver, os.X_OK):
+        sys.exit(f"No WordleSolver in {args.build}, build it first or pass --build")
+    out_dir = os.path.join(args.build, "perf_data")
+    os.makedirs(out_dir, exist_ok=True)
+
+    commit = git("rev-parse", "--short", "HEAD")
+    dirty = bool(git("status", "--porcelain", "--untracked-files=no"))
+    host = socket.gethostname()
+    history = load_history(args.history)
+
+    entries, failures = [], []
+    for name in args.workload or list(WORKLOADS):
+        result = run_workload(solver, name, args.runs, out_dir)
+        base = baseline(history, name, host, commit)
+        print(f"{name:8} {result['best']} at {result['cost']}  {result['wall_s']:8.3f}s  {result['nodes']:>10} nodes  "
+              f"{result['hit_rate']:6.2f}% hits  {result['peak_rss_mb']:8.1f} MB"
+              + (f"   (vs {base['commit']}: {base['wall_s']:.3f}s)" if base else "   (no baseline)"))
+        if base:
+            failures += compare(name, result, base, args)
+        entries.append(dict(result, workload=name, about=WORKLOADS[name]["about"], commit=commit, dirty=dirty, host=host,
+                            date=datetime.date.today().isoformat(),
+                            label=args.label or git("log", "-1", "--format=%s")))
+
+    for failure in failures:
+        print("REGRESSION " + failure)
+
+    if args.record and (not failures or args.force):
+        with open(args.history, "a") as f:
+            for entry in entries:
+                f.write(json.dumps(entry) + "\n")
+        print(f"Recorded {len(entries)} results for {commit}{' (dirty)' if dirty else ''} in {args.history}")
+
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+#include "Checkpoint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr char MAGIC[8] = {'W', 'R', 'D', 'L', 'C', 'K', 'P', 'T'};
+constexpr uint32_t VERSION = 3; // 2: memo dump names its backend, 3: opener costs
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t state_width;
+    uint64_t words_hash;
+    double global_min;
+    int32_t best_index;
+    uint32_t num_completed;
+};
+
+} // namespace
+
+template <int N>
+void save_checkpoint(const std::string& path, const Wordle& game, const RunState& state, const MemoizationTable<N>& cache) {
+    std::string temp_path = path + ".tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            throw std::runtime_error("Couldn't open checkpoint file " + temp_path);
+
+        Header header {};
+        std::copy(std::begin(MAGIC), std::end(MAGIC), header.magic);
+        header.version = VERSION;
+        header.state_width = N;
+        header.words_hash = game.word_list_hash();
+        header.global_min = state.global_min;
+        header.best_index = state.best_index;
+        header.num_completed = static_cast<uint32_t>(state.completed.size());
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (state.costs.size() != state.completed.size() || state.cut.size() != state.completed.size())
+            throw std::runtime_error("RunState has costs for " + std::to_string(state.costs.size()) + " of "
+                                     + std::to_string(state.completed.size()) + " openers");
+
+        out.write(reinterpret_cast<const char*>(state.completed.data()),
+                  static_cast<std::streamsize>(state.completed.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(state.costs.data()),
+                  static_cast<std::streamsize>(state.costs.size() * sizeof(double)));
+        out.write(reinterpret_cast<const char*>(state.cut.data()), static_cast<std::streamsize>(state.cut.size()));
+        cache.save(out);
+
+        out.flush();
+        if (!out) throw std::runtime_error("Failed writing checkpoint " + temp_path);
+    }
+
+    // Atomic on POSIX, so readers see either the old checkpoint or the whole new one
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Couldn't move checkpoint into place at " + path);
+}
+
+template <int N>
+bool load_checkpoint(const std::string& path, const Wordle& game, RunState& state, MemoizationTable<N>& cache) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    Header header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || !std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic))
+        throw std::runtime_error(path + " isn't a checkpoint");
+    if (header.version != VERSION)
+        throw std::runtime_error(path + " is checkpoint version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION));
+    if (header.state_width != N || header.words_hash != game.word_list_hash())
+        throw std::runtime_error(path + " was made with different word lists");
+
+    RunState loaded;
+    loaded.global_min = header.global_min;
+    loaded.best_index = header.best_index;
+    loaded.completed.resize(header.num_completed);
+    loaded.costs.resize(header.num_completed);
+    loaded.cut.resize(header.num_completed);
+    if (!in.read(reinterpret_cast<char*>(loaded.completed.data()), static_cast<std::streamsize>(header.num_completed * sizeof(int)))
+        || !in.read(reinterpret_cast<char*>(loaded.costs.data()), static_cast<std::streamsize>(header.num_completed * sizeof(double)))
+        || !in.read(reinterpret_cast<char*>(loaded.cut.data()), static_cast<std::streamsize>(header.num_completed)))
+        throw std::runtime_error(path + " ends early");
+
+    for (int guess : loaded.completed)
+        if (guess < 0 || guess >= game.num_guesses())
+            throw std::runtime_error(path + " has an out of range opener");
+
+    cache.load(in);
+    state = std::move(loaded);
+    return true;
+}
+
+#define INSTANTIATE(W) \
+    template void save_checkpoint<W>(const std::string&, const Wordle&, const RunState&, const MemoizationTable<W>&); \
+    template bool load_checkpoint<W>(const std::string&, const Wordle&, RunState&, MemoizationTable<W>&);
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
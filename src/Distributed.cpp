@@ -0,0 +1,231 @@
+#include "Distributed.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+using namespace memo_dump;
+
+template <int N>
+Distributed<N>::Distributed(const Config& c, MemoizationTable<N>& m, std::atomic<double>& budget)
+    : config(c), cache(m), root_budget(budget), last_exchange(std::chrono::steady_clock::now()) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    // Every rank has to make the window, but only rank 0's has the counter in it
+    MPI_Aint bytes = (my_rank == 0) ? sizeof(int) : 0;
+    MPI_Win_allocate(bytes, sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD, &ticket_counter, &ticket_window);
+    if (my_rank == 0) *ticket_counter = 0;
+    MPI_Barrier(MPI_COMM_WORLD); // Nobody takes a ticket before it's zeroed
+}
+
+template <int N>
+Distributed<N>::~Distributed() {
+    reap_sends(true);
+    MPI_Win_free(&ticket_window);
+}
+
+template <int N>
+int Distributed<N>::next_ticket() {
+    std::lock_guard<std::mutex> lock(mpi_mutex);
+
+    const int one = 1;
+    int ticket;
+    MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, ticket_window);
+    MPI_Fetch_and_op(&one, &ticket, MPI_INT, 0, 0, MPI_SUM, ticket_window);
+    MPI_Win_unlock(0, ticket_window);
+    return ticket;
+}
+
+template <int N>
+void Distributed<N>::maybe_exchange() {
+    std::unique_lock<std::mutex> lock(exchange_mutex, std::try_to_lock);
+    if (!lock) return;
+    if (std::chrono::steady_clock::now() - last_exchange < std::chrono::seconds(config.exchange_interval)) return;
+
+    exchange();
+    last_exchange = std::chrono::steady_clock::now();
+}
+
+template <int N>
+void Distributed<N>::exchange() {
+    if (num_ranks == 1) return;
+    send_new_entries();
+
+    std::lock_guard<std::mutex> lock(mpi_mutex);
+    receive_entries(true);
+    reap_sends(false);
+}
+
+template <int N>
+void Distributed<N>::finish() {
+    std::lock_guard<std::mutex> exchanging(exchange_mutex);
+    exchange();
+
+    std::lock_guard<std::mutex> lock(mpi_mutex);
+    for (int r = 0; r < num_ranks; ++r)
+        if (r != my_rank) MPI_Send(nullptr, 0, MPI_BYTE, r, TAG_DONE, MPI_COMM_WORLD);
+
+    // A rank's messages arrive in the order they were sent, so nothing comes from it after its done
+    // This rank's search is over, so whatever is still coming only needs draining
+    int num_done = 0;
+    while (num_done < num_ranks - 1) {
+        MPI_Status status;
+        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        if (status.MPI_TAG == TAG_DONE) {
+            MPI_Recv(nullptr, 0, MPI_BYTE, status.MPI_SOURCE, TAG_DONE, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            num_done++;
+        } else {
+            receive_entries(false);
+        }
+    }
+    reap_sends(true);
+}
+
+template <int N>
+uint64_t Distributed<N>::share_key(const StateBitset<N>& state, int depth) {
+    return (std::hash<StateBitset<N>>{}(state) ^ static_cast<uint64_t>(depth)) * 0x9e3779b97f4a7c15ull;
+}
+
+// -- Sending and receiving --
+
+// A message is the sender's top-k bar, then the memo dump layout from MemoBackend.hpp
+template <int N>
+void Distributed<N>::send_new_entries() {
+    std::vector<char> agnostic, specific;
+    uint64_t num_agnostic = 0, num_specific = 0;
+
+    cache.for_each([&](const StateBitset<N>& state, int depth, const SearchResult& res) {
+        if (depth > config.share_max_depth || state.count() < config.share_min_size) return;
+        if (!shared.insert(share_key(state, depth)).second) return;
+
+        if (depth == 0) {
+            put_agnostic(agnostic, state, res.expected_cost, static_cast<int16_t>(res.best_guess_index),
+                         static_cast<uint8_t>(res.max_height));
+            num_agnostic++;
+        } else {
+            put_specific(specific, state, static_cast<uint8_t>(depth), res.expected_cost,
+                         static_cast<int16_t>(res.best_guess_index));
+            num_specific++;
+        }
+    });
+
+    double budget = root_budget.load();
+    if (num_agnostic == 0 && num_specific == 0 && budget == NO_BUDGET) return;
+
+    std::ostringstream out;
+    out.write(reinterpret_cast<const char*>(&budget), sizeof(budget));
+    if (num_agnostic != 0) write_chunk(out, num_agnostic, agnostic);
+    write_chunk(out, 0, {});
+    if (num_specific != 0) write_chunk(out, num_specific, specific);
+    write_chunk(out, 0, {});
+
+    std::string bytes = out.str();
+    if (bytes.size() > static_cast<size_t>(std::numeric_limits<int>::max()))
+        throw std::runtime_error("Memo exchange of " + std::to_string(bytes.size()) + " bytes is too big for one message");
+
+    std::lock_guard<std::mutex> lock(mpi_mutex);
+    outgoing.push_back({ std::vector<char>(bytes.begin(), bytes.end()), {} });
+    Outgoing& send = outgoing.back();
+    for (int r = 0; r < num_ranks; ++r) {
+        if (r == my_rank) continue;
+        send.requests.emplace_back();
+        MPI_Isend(send.message.data(), static_cast<int>(send.message.size()), MPI_BYTE, r, TAG_ENTRIES, MPI_COMM_WORLD,
+                  &send.requests.back());
+    }
+}
+
+// Takes every entries message that's already arrived. Needs mpi_mutex
+template <int N>
+void Distributed<N>::receive_entries(bool insert) {
+    while (true) {
+        int waiting = 0;
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, TAG_ENTRIES, MPI_COMM_WORLD, &waiting, &status);
+        if (!waiting) return;
+
+        int bytes = 0;
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        std::string message(static_cast<size_t>(bytes), '\0');
+        MPI_Recv(message.data(), bytes, MPI_BYTE, status.MPI_SOURCE, TAG_ENTRIES, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if (!insert) continue;
+
+        std::istringstream in(message);
+        double budget;
+        if (!in.read(reinterpret_cast<char*>(&budget), sizeof(budget)))
+            throw std::runtime_error("Memo exchange message from rank " + std::to_string(status.MPI_SOURCE) + " is empty");
+
+        double current = root_budget.load();
+        while (budget < current && !root_budget.compare_exchange_weak(current, budget)) {}
+
+        read_state_records<N>(in, [&](const StateBitset<N>& state, int depth, const SearchResult& result) {
+            shared.insert(share_key(state, depth)); // Every rank already has it
+            cache.insert(state, depth, result);
+        });
+    }
+}
+
+// Frees the buffers of finished sends. Needs mpi_mutex
+template <int N>
+void Distributed<N>::reap_sends(bool wait) {
+    for (Outgoing& send : outgoing) {
+        if (wait) {
+            MPI_Waitall(static_cast<int>(send.requests.size()), send.requests.data(), MPI_STATUSES_IGNORE);
+        } else {
+            int done = 0;
+            MPI_Testall(static_cast<int>(send.requests.size()), send.requests.data(), &done, MPI_STATUSES_IGNORE);
+        }
+    }
+
+    // Finished requests were set to MPI_REQUEST_NULL
+    outgoing.erase(std::remove_if(outgoing.begin(), outgoing.end(), [](const Outgoing& send) {
+        return std::all_of(send.requests.begin(), send.requests.end(), [](MPI_Request r) { return r == MPI_REQUEST_NULL; });
+    }), outgoing.end());
+}
+
+// -- Results --
+
+template <int N>
+RunState Distributed<N>::gather(const RunState& local, SolverStats& stats) {
+    std::lock_guard<std::mutex> lock(mpi_mutex);
+
+    // SolverStats is nothing but longs
+    static_assert(sizeof(SolverStats) % sizeof(long) == 0);
+    SolverStats total;
+    MPI_Reduce(&stats, &total, sizeof(SolverStats) / sizeof(long), MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    int count = static_cast<int>(local.completed.size());
+    std::vector<int> counts(num_ranks), offsets(num_ranks);
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    int num_total = 0;
+    for (int r = 0; r < num_ranks; ++r) {
+        offsets[r] = num_total;
+        num_total += counts[r];
+    }
+
+    RunState all;
+    all.completed.resize(my_rank == 0 ? num_total : 0);
+    all.costs.resize(all.completed.size());
+    all.cut.resize(all.completed.size());
+
+    MPI_Gatherv(local.completed.data(), count, MPI_INT, all.completed.data(), counts.data(), offsets.data(), MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gatherv(local.costs.data(), count, MPI_DOUBLE, all.costs.data(), counts.data(), offsets.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gatherv(local.cut.data(), count, MPI_UINT8_T, all.cut.data(), counts.data(), offsets.data(), MPI_UINT8_T, 0, MPI_COMM_WORLD);
+
+    if (my_rank != 0) return local;
+
+    stats = total;
+    for (size_t i = 0; i < all.completed.size(); ++i) {
+        if (!all.cut[i] && all.costs[i] < all.global_min) {
+            all.global_min = all.costs[i];
+            all.best_index = all.completed[i];
+        }
+    }
+    return all;
+}
+
+#define INSTANTIATE(W) template class Distributed<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,140 @@
+#include "ExactMemo.hpp"
+#include <string>
+
+using namespace memo_dump;
+
+template <int N>
+ExactMemo<N>::ExactMemo(const Config& c) : MemoBackend<N>(c) {
+    // Most states only ever get one kind of value, so one entry per state covers both old reserves
+    map.reserve(std::max(c.agnostic_reserve, c.specific_reserve));
+}
+
+
+template <int N>
+std::optional<SearchResult> ExactMemo<N>::get(const StateBitset<N>& state, int depth) {
+    std::optional<SearchResult> result = std::nullopt;
+
+    // Mutable, since a hit earns a CLOCK credit
+    map.modify_if(state, [&](auto& kv) {
+        Entry& entry = kv.second;
+
+        if ((entry.present & AGNOSTIC_BIT) && depth + entry.agnostic_height <= MAX_DEPTH) {
+            result = SearchResult{ entry.agnostic_cost, entry.agnostic_guess, entry.agnostic_height };
+        } else if (depth >= 1 && depth <= MAX_DEPTH && (entry.present & (1u << depth))) {
+            result = SearchResult{ entry.specific_cost[depth - 1], entry.specific_guess[depth - 1], 7 - depth };
+        }
+
+        if (result && entry.credit < MAX_CREDIT) entry.credit++;
+    });
+
+    return result;
+}
+
+template <int N>
+bool ExactMemo<N>::fill(Entry& entry, int depth, const SearchResult& result) {
+    bool is_clean_value = (depth + result.max_height <= MAX_DEPTH);
+
+    if (is_clean_value) {
+        if (entry.present & AGNOSTIC_BIT) return false;
+        entry.agnostic_cost = result.expected_cost;
+        entry.agnostic_guess = static_cast<int16_t>(result.best_guess_index);
+        entry.agnostic_height = static_cast<uint8_t>(result.max_height);
+        entry.present |= AGNOSTIC_BIT;
+        return true;
+    }
+
+    if (depth < 1 || depth > MAX_DEPTH)
+        throw std::runtime_error("No specific memo slot for depth " + std::to_string(depth));
+
+    if (entry.present & (1u << depth)) return false;
+    entry.specific_cost[depth - 1] = result.expected_cost;
+    entry.specific_guess[depth - 1] = static_cast<int16_t>(result.best_guess_index);
+    entry.present |= static_cast<uint8_t>(1u << depth);
+    return true;
+}
+
+template <int N>
+MemoInsert ExactMemo<N>::insert(const StateBitset<N>& state, int depth, const SearchResult& result) {
+    Entry entry {};
+    entry.credit = initial_credit(state);
+    fill(entry, depth, result);
+
+    bool filled = true;
+    bool is_new = map.try_emplace_l(state, [&](auto& kv) { filled = fill(kv.second, depth, result); }, entry);
+
+    if (is_new) added(map, hands, state, ENTRY_BYTES);
+    return filled ? MemoInsert::Added : MemoInsert::Present;
+}
+
+template <int N>
+size_t ExactMemo<N>::size() const {
+    size_t values = 0;
+    for (size_t i = 0; i < map.subcnt(); ++i) {
+        map.with_submap(i, [&](const auto& submap) {
+            for (const auto& kv : submap)
+                values += __builtin_popcount(kv.second.present);
+        });
+    }
+    return values;
+}
+
+template <int N>
+void ExactMemo<N>::for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const {
+    for (size_t i = 0; i < map.subcnt(); ++i) {
+        map.with_submap(i, [&](const auto& submap) {
+            for (const auto& [state, entry] : submap) {
+                if (entry.present & AGNOSTIC_BIT)
+                    f(state, 0, SearchResult{ entry.agnostic_cost, entry.agnostic_guess, entry.agnostic_height });
+
+                for (int d = 1; d <= MAX_DEPTH; ++d)
+                    if (entry.present & (1u << d))
+                        f(state, d, SearchResult{ entry.specific_cost[d - 1], entry.specific_guess[d - 1], 7 - d });
+            }
+        });
+    }
+}
+
+// -- Persistence --
+
+// Layout is in MemoBackend.hpp. The same as when they were two maps
+template <int N>
+void ExactMemo<N>::save(std::ostream& out) const {
+    std::vector<char> buf;
+
+    for (bool agnostic : {true, false}) {
+        for (size_t i = 0; i < map.subcnt(); ++i) {
+            buf.clear();
+            uint64_t count = 0;
+            map.with_submap(i, [&](const auto& submap) {
+                for (const auto& [state, entry] : submap) {
+                    if (agnostic) {
+                        if (!(entry.present & AGNOSTIC_BIT)) continue;
+                        put_agnostic(buf, state, entry.agnostic_cost, entry.agnostic_guess, entry.agnostic_height);
+                        count++;
+                        continue;
+                    }
+
+                    for (uint8_t d = 1; d <= MAX_DEPTH; ++d) {
+                        if (!(entry.present & (1u << d))) continue;
+                        put_specific(buf, state, d, entry.specific_cost[d - 1], entry.specific_guess[d - 1]);
+                        count++;
+                    }
+                }
+            });
+            if (count != 0) write_chunk(out, count, buf);
+        }
+        write_chunk(out, 0, {});
+    }
+}
+
+template <int N>
+void ExactMemo<N>::load(std::istream& in) {
+    // Agnostic records come back at depth 0, which always counts as clean for them
+    read_state_records<N>(in, [&](const StateBitset<N>& state, int depth, const SearchResult& result) {
+        insert(state, depth, result);
+    });
+}
+
+#define INSTANTIATE(W) template class ExactMemo<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,185 @@
+#include "FingerprintMemo.hpp"
+
+using namespace memo_dump;
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+} // namespace
+
+// MurmurHash3 x64_128 over the state words, two at a time
+template <int N>
+typename FingerprintMemo<N>::Fingerprint FingerprintMemo<N>::fingerprint(const StateBitset<N>& state) {
+    constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+    constexpr int NUM_WORDS = StateBitset<N>::NUM_WORDS;
+
+    uint64_t h1 = 0, h2 = 0;
+    int w = 0;
+    for (; w + 1 < NUM_WORDS; w += 2) {
+        uint64_t k1 = state.words[w], k2 = state.words[w + 1];
+
+        k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; h1 ^= k1;
+        h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= C2; k2 = rotl(k2, 33); k2 *= C1; h2 ^= k2;
+        h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+    if (w < NUM_WORDS) {
+        uint64_t k1 = state.words[w];
+        k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; h1 ^= k1;
+    }
+
+    h1 ^= NUM_WORDS * sizeof(uint64_t);
+    h2 ^= NUM_WORDS * sizeof(uint64_t);
+    h1 += h2; h2 += h1;
+    h1 = fmix(h1); h2 = fmix(h2);
+    h1 += h2; h2 += h1;
+
+    return Fingerprint{ h1, h2 };
+}
+
+template <int N>
+FingerprintMemo<N>::FingerprintMemo(const Config& c) : MemoBackend<N>(c), verify(c.memo_verify) {
+    agnostic_map.reserve(c.agnostic_reserve);
+    specific_map.reserve(c.specific_reserve);
+}
+
+template <int N>
+bool FingerprintMemo<N>::verify_state(const Fingerprint& f, const StateBitset<N>& state, bool claim) {
+    bool matches = true;
+    auto check = [&](const auto& kv) { matches = (kv.second == state); };
+
+    if (claim) verify_map.try_emplace_l(f, check, state);
+    else verify_map.if_contains(f, check);
+
+    if (!matches) t_stats.fingerprint_collisions++;
+    return matches;
+}
+
+template <int N>
+std::optional<SearchResult> FingerprintMemo<N>::get(const StateBitset<N>& state, int depth) {
+    std::optional<SearchResult> result = std::nullopt;
+    Fingerprint f = fingerprint(state);
+
+    // Same rules as ExactMemo, only the keys differ
+    agnostic_map.modify_if(f, [&](auto& kv) {
+        Entry& entry = kv.second;
+
+        if (depth + entry.max_subtree_height <= 6) {
+            result = SearchResult{ entry.expected_guesses, entry.best_guess_index, entry.max_subtree_height };
+            if (entry.credit < MAX_CREDIT) entry.credit++;
+        }
+    });
+
+    if (!result) {
+        specific_map.modify_if(specific_key(f, depth), [&](auto& kv) {
+            Entry& entry = kv.second;
+
+            result = SearchResult{ entry.expected_guesses, entry.best_guess_index, 7 - depth };
+            if (entry.credit < MAX_CREDIT) entry.credit++;
+        });
+    }
+
+    if (result && verify && !verify_state(f, state, false))
+        return std::nullopt;
+    return result;
+}
+
+template <int N>
+MemoInsert FingerprintMemo<N>::insert(const StateBitset<N>& state, int depth, const SearchResult& result) {
+    Fingerprint f = fingerprint(state);
+    if (verify && !verify_state(f, state, true))
+        return MemoInsert::Dropped; // The slot belongs to the other state
+
+    bool is_clean_value = (depth + result.max_height <= 6);
+    Entry entry {
+        result.expected_cost,
+        static_cast<int16_t>(result.best_guess_index),
+        static_cast<uint8_t>(is_clean_value ? result.max_height : 0),
+        initial_credit(state)
+    };
+
+    bool inserted = is_clean_value
+        ? emplace(agnostic_map, agnostic_hands, f, entry, ENTRY_BYTES)
+        : emplace(specific_map, specific_hands, specific_key(f, depth), entry, ENTRY_BYTES);
+    return inserted ? MemoInsert::Added : MemoInsert::Present;
+}
+
+template <int N>
+void FingerprintMemo<N>::for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>&) const {
+    throw std::runtime_error("The fingerprint memo doesn't keep states, so it can't list its entries");
+}
+
+// -- Persistence --
+
+/*
+ * Layout: the agnostic chunks, a 0, the specific chunks, and a 0
+ * Both records are: uint64 lo, uint64 hi, double cost, int16 guess, uint8 height, uint8 credit
+ *   (specific keys already have the depth folded in)
+ * Verify mode's states aren't saved, so a resumed run only checks what it inserts itself
+ */
+template <int N>
+void FingerprintMemo<N>::save(std::ostream& out) const {
+    std::vector<char> buf;
+
+    for (const Map* map : {&agnostic_map, &specific_map}) {
+        for (size_t i = 0; i < map->subcnt(); ++i) {
+            buf.clear();
+            uint64_t count = 0;
+            map->with_submap(i, [&](const auto& submap) {
+                for (const auto& [f, entry] : submap) {
+                    put(buf, f.lo);
+                    put(buf, f.hi);
+                    put(buf, entry.expected_guesses);
+                    put(buf, entry.best_guess_index);
+                    put(buf, entry.max_subtree_height);
+                    put(buf, entry.credit);
+                    count++;
+                }
+            });
+            if (count != 0) write_chunk(out, count, buf);
+        }
+        write_chunk(out, 0, {});
+    }
+}
+
+template <int N>
+void FingerprintMemo<N>::load(std::istream& in) {
+    constexpr size_t RECORD = 2 * sizeof(uint64_t) + sizeof(double) + sizeof(int16_t) + 2 * sizeof(uint8_t);
+    std::vector<char> buf;
+    uint64_t count;
+
+    for (Map* map : {&agnostic_map, &specific_map}) {
+        auto& hands = (map == &agnostic_map) ? agnostic_hands : specific_hands;
+
+        while (read_chunk(in, RECORD, count, buf)) {
+            const char* ptr = buf.data();
+            for (uint64_t r = 0; r < count; ++r) {
+                Fingerprint f;
+                f.lo = take<uint64_t>(ptr);
+                f.hi = take<uint64_t>(ptr);
+                Entry entry;
+                entry.expected_guesses = take<double>(ptr);
+                entry.best_guess_index = take<int16_t>(ptr);
+                entry.max_subtree_height = take<uint8_t>(ptr);
+                entry.credit = take<uint8_t>(ptr); // No state to weigh, so keep what it had
+                emplace(*map, hands, f, entry, ENTRY_BYTES);
+            }
+        }
+    }
+}
+
+#define INSTANTIATE(W) template class FingerprintMemo<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,213 @@
+#include "Kernels.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define WORDLE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Below this many active answers in a word, visiting just the set bits beats counting the whole block
+constexpr int DENSE_WORD = 16;
+
+// The SIMD histograms count inactive answers as this pattern too, then take them back out at the end
+constexpr uint8_t FILLER_PATTERN = NUM_PATTERNS - 1;
+
+void count_sparse_word(const uint8_t* block, uint64_t bits, int* counts) {
+    while (bits) {
+        counts[block[__builtin_ctzll(bits)]]++;
+        bits &= bits - 1;
+    }
+}
+
+// -- Scalar --
+
+// 8 LUT bytes to an 8 bit mask of which equal the target, without a branch per byte (little endian)
+inline uint64_t swar_match8(uint64_t bytes, uint64_t target_bytes) {
+    constexpr uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+    uint64_t x = bytes ^ target_bytes; // Matching bytes are now 0
+    uint64_t zero = ~(((x & LOW7) + LOW7) | x | LOW7); // Only the high bit of each zero byte is left
+    return ((zero >> 7) * 0x0102040810204080ULL) >> 56; // Gathers those 8 bits into the top byte
+}
+
+void match_pattern_scalar(const uint8_t* row, uint8_t target, const uint64_t* in, uint64_t* out, int num_words) {
+    const uint64_t target_bytes = 0x0101010101010101ULL * target;
+
+    for (int w = 0; w < num_words; ++w) {
+        if (in[w] == 0) { // Most words of a deep state are empty, and this path pays per byte
+            out[w] = 0;
+            continue;
+        }
+
+        uint64_t mask = 0;
+        for (int b = 0; b < 8; ++b) {
+            uint64_t bytes;
+            std::memcpy(&bytes, row + w * 64 + b * 8, sizeof(bytes));
+            mask |= swar_match8(bytes, target_bytes) << (b * 8);
+        }
+        out[w] = in[w] & mask;
+    }
+}
+
+void count_patterns_scalar(const uint8_t* row, const uint64_t* state, int num_words, int* counts) {
+    for (int w = 0; w < num_words; ++w)
+        count_sparse_word(row + w * 64, state[w], counts);
+}
+
+#ifdef WORDLE_X86
+
+// -- AVX2 --
+
+__attribute__((target("avx2")))
+void match_pattern_avx2(const uint8_t* row, uint8_t target, const uint64_t* in, uint64_t* out, int num_words) {
+    __m256i targets = _mm256_set1_epi8(static_cast<char>(target));
+
+    // A 256 bit register holds 32 LUT bytes, so each word is two halves
+    for (int w = 0; w < num_words; ++w) {
+        const uint8_t* low_ptr = row + (w * 64);
+
+        __m256i low_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(low_ptr));
+        uint32_t low_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low_vec, targets)));
+
+        __m256i hi_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(low_ptr + 32));
+        uint32_t hi_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi_vec, targets)));
+
+        uint64_t combined_mask = static_cast<uint64_t>(low_mask) | (static_cast<uint64_t>(hi_mask) << 32);
+        out[w] = in[w] & combined_mask;
+    }
+}
+
+// Byte i of the result is 0xFF if bit i of bits is on
+__attribute__((target("avx2")))
+inline __m256i expand_bits_avx2(uint32_t bits) {
+    // shuffle_epi8 stays inside each 128 bit lane, and both lanes hold all 4 bytes of bits
+    const __m256i spread = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bit_select = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+
+    __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(bits)), spread);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit_select), bit_select);
+}
+
+__attribute__((target("avx2")))
+void count_patterns_avx2(const uint8_t* row, const uint64_t* state, int num_words, int* counts) {
+    const __m256i filler = _mm256_set1_epi8(static_cast<char>(FILLER_PATTERN));
+    alignas(32) uint8_t block[64];
+    int filled = 0;
+
+    for (int w = 0; w < num_words; ++w) {
+        uint64_t bits = state[w];
+        int active = __builtin_popcountll(bits);
+        if (active < DENSE_WORD) {
+            count_sparse_word(row + w * 64, bits, counts);
+            continue;
+        }
+
+        // Dense, so swap the inactive bytes for the filler and count all 64 without touching the bits
+        for (int half = 0; half < 2; ++half) {
+            __m256i vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + w * 64 + half * 32));
+            __m256i keep = expand_bits_avx2(static_cast<uint32_t>(bits >> (half * 32)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(block + half * 32), _mm256_blendv_epi8(filler, vec, keep));
+        }
+        for (uint8_t p : block) counts[p]++;
+        filled += 64 - active;
+    }
+
+    counts[FILLER_PATTERN] -= filled;
+}
+
+// -- AVX-512 --
+
+__attribute__((target("avx512f,avx512bw")))
+void match_pattern_avx512(const uint8_t* row, uint8_t target, const uint64_t* in, uint64_t* out, int num_words) {
+    __m512i targets = _mm512_set1_epi8(static_cast<char>(target));
+
+    // One register is a whole word, and the compare gives the 64 bit mask directly
+    for (int w = 0; w < num_words; ++w) {
+        __m512i vec = _mm512_loadu_si512(row + w * 64);
+        out[w] = in[w] & static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(vec, targets));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void count_patterns_avx512(const uint8_t* row, const uint64_t* state, int num_words, int* counts) {
+    const __m512i filler = _mm512_set1_epi8(static_cast<char>(FILLER_PATTERN));
+    alignas(64) uint8_t block[64];
+    int filled = 0;
+
+    for (int w = 0; w < num_words; ++w) {
+        uint64_t bits = state[w];
+        int active = __builtin_popcountll(bits);
+        if (active < DENSE_WORD) {
+            count_sparse_word(row + w * 64, bits, counts);
+            continue;
+        }
+
+        // The state word is already the blend mask. One full store, since splitting it into 256 bit halves
+        // (castsi512_si256 and extracti64x4) leaves GCC warning about the cast's undefined upper half
+        __m512i vec = _mm512_mask_blend_epi8(static_cast<__mmask64>(bits), filler, _mm512_loadu_si512(row + w * 64));
+        _mm512_store_si512(block, vec);
+        for (uint8_t p : block) counts[p]++;
+        filled += 64 - active;
+    }
+
+    counts[FILLER_PATTERN] -= filled;
+}
+
+#endif // WORDLE_X86
+
+const Kernels SCALAR_KERNELS { KernelPath::Scalar, "scalar", match_pattern_scalar, count_patterns_scalar };
+#ifdef WORDLE_X86
+const Kernels AVX2_KERNELS { KernelPath::AVX2, "avx2", match_pattern_avx2, count_patterns_avx2 };
+const Kernels AVX512_KERNELS { KernelPath::AVX512, "avx512", match_pattern_avx512, count_patterns_avx512 };
+#endif
+
+} // namespace
+
+bool kernel_supported(KernelPath path) {
+    switch (path) {
+        case KernelPath::Auto:
+        case KernelPath::Scalar:
+            return true;
+#ifdef WORDLE_X86
+        case KernelPath::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case KernelPath::AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+        default:
+            return false;
+    }
+}
+
+const Kernels& get_kernels(KernelPath path) {
+    if (path == KernelPath::Auto) {
+        if (kernel_supported(KernelPath::AVX512)) path = KernelPath::AVX512;
+        else if (kernel_supported(KernelPath::AVX2)) path = KernelPath::AVX2;
+        else path = KernelPath::Scalar;
+    }
+
+    if (!kernel_supported(path))
+        throw std::runtime_error("This CPU can't run the requested kernels");
+
+    switch (path) {
+#ifdef WORDLE_X86
+        case KernelPath::AVX512: return AVX512_KERNELS;
+        case KernelPath::AVX2: return AVX2_KERNELS;
+#endif
+        default: return SCALAR_KERNELS;
+    }
+}
+
+KernelPath parse_kernel_path(const std::string& name) {
+    if (name == "auto") return KernelPath::Auto;
+    if (name == "scalar") return KernelPath::Scalar;
+    if (name == "avx2") return KernelPath::AVX2;
+    if (name == "avx512") return KernelPath::AVX512;
+    throw std::runtime_error("Unknown kernel path " + name + " (expected auto, scalar, avx2 or avx512)");
+}
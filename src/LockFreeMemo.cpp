@@ -0,0 +1,193 @@
+#include "LockFreeMemo.hpp"
+#include <string>
+
+using namespace memo_dump;
+
+template <int N>
+LockFreeMemo<N>::LockFreeMemo(const Config& c) : MemoBackend<N>(c) {
+    size_t num_slots;
+    if (budget_bytes != 0) {
+        // Nodes plus the slots pointing at them (a little over 2 per node, with the pow2 rounding) fill the budget
+        max_nodes = std::max<size_t>(budget_bytes / (sizeof(Node) + 3 * sizeof(std::atomic<Node*>)), 1);
+        num_slots = 1;
+        while (num_slots < max_nodes + max_nodes / 7 + 1) num_slots <<= 1;
+    } else {
+        num_slots = size_t(1) << c.lockfree_slots_log2;
+        max_nodes = num_slots - num_slots / 8;
+    }
+
+    mask = num_slots - 1;
+    slots = std::make_unique<std::atomic<Node*>[]>(num_slots);
+    for (size_t i = 0; i < num_slots; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    used_bytes.store(num_slots * sizeof(std::atomic<Node*>), std::memory_order_relaxed);
+}
+
+template <int N>
+LockFreeMemo<N>::~LockFreeMemo() {
+    for (size_t i = 0; i <= mask; ++i)
+        delete slots[i].load(std::memory_order_relaxed);
+}
+
+template <int N>
+const typename LockFreeMemo<N>::Node* LockFreeMemo<N>::find(const StateBitset<N>& state, uint64_t hash) const {
+    for (size_t i = home(hash), step = 0; step <= mask; i = (i + 1) & mask, ++step) {
+        const Node* node = slots[i].load(std::memory_order_acquire);
+        if (!node) return nullptr; // Slots never empty out again, so the state would have been here
+        if (node->hash == hash && node->state == state) return node;
+    }
+    return nullptr;
+}
+
+template <int N>
+std::optional<SearchResult> LockFreeMemo<N>::get(const StateBitset<N>& state, int depth) {
+    const Node* node = find(state, std::hash<StateBitset<N>>{}(state));
+    if (!node) return std::nullopt;
+
+    uint16_t published = node->bits.load(std::memory_order_acquire) >> PUBLISHED_SHIFT;
+
+    if ((published & AGNOSTIC_BIT) && depth + node->agnostic_height <= MAX_DEPTH)
+        return SearchResult{ node->agnostic_cost, node->agnostic_guess, node->agnostic_height };
+
+    if (depth >= 1 && depth <= MAX_DEPTH && (published & (1u << depth)))
+        return SearchResult{ node->specific_cost[depth - 1], node->specific_guess[depth - 1], 7 - depth };
+
+    return std::nullopt;
+}
+
+template <int N>
+bool LockFreeMemo<N>::fill(Node& node, int depth, const SearchResult& result) {
+    bool is_clean_value = (depth + result.max_height <= MAX_DEPTH);
+    if (!is_clean_value && (depth < 1 || depth > MAX_DEPTH))
+        throw std::runtime_error("No specific memo slot for depth " + std::to_string(depth));
+
+    uint16_t bit = is_clean_value ? AGNOSTIC_BIT : static_cast<uint16_t>(1u << depth);
+
+    // Claiming first means only one writer ever touches these fields, and readers wait for the published bit
+    if (node.bits.fetch_or(bit, std::memory_order_relaxed) & bit) return false;
+
+    if (is_clean_value) {
+        node.agnostic_cost = result.expected_cost;
+        node.agnostic_guess = static_cast<int16_t>(result.best_guess_index);
+        node.agnostic_height = static_cast<uint8_t>(result.max_height);
+    } else {
+        node.specific_cost[depth - 1] = result.expected_cost;
+        node.specific_guess[depth - 1] = static_cast<int16_t>(result.best_guess_index);
+    }
+
+    node.bits.fetch_or(static_cast<uint16_t>(bit << PUBLISHED_SHIFT), std::memory_order_release);
+    return true;
+}
+
+template <int N>
+MemoInsert LockFreeMemo<N>::insert(const StateBitset<N>& state, int depth, const SearchResult& result) {
+    uint64_t hash = std::hash<StateBitset<N>>{}(state);
+
+    for (size_t i = home(hash), step = 0; step <= mask; i = (i + 1) & mask, ++step) {
+        Node* node = slots[i].load(std::memory_order_acquire);
+
+        if (!node) {
+            // Room is reserved before allocating, so a full table costs nothing, and racing inserts can't overfill it
+            if (num_nodes.fetch_add(1, std::memory_order_relaxed) >= max_nodes) {
+                num_nodes.fetch_sub(1, std::memory_order_relaxed);
+                t_stats.memo_evictions++;
+                return MemoInsert::Dropped;
+            }
+
+            auto fresh = std::make_unique<Node>();
+            fresh->hash = hash;
+            fresh->state = state;
+            fill(*fresh, depth, result);
+
+            if (slots[i].compare_exchange_strong(node, fresh.get(), std::memory_order_release, std::memory_order_acquire)) {
+                fresh.release();
+                used_bytes.fetch_add(sizeof(Node), std::memory_order_relaxed);
+                return MemoInsert::Added;
+            }
+
+            // Lost the slot. node is now whatever won it, which might be this same state
+            num_nodes.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (node->hash == hash && node->state == state)
+            return fill(*node, depth, result) ? MemoInsert::Added : MemoInsert::Present;
+    }
+
+    return MemoInsert::Dropped; // Unreachable, max_nodes leaves empty slots
+}
+
+template <int N>
+template <typename F>
+void LockFreeMemo<N>::visit(const Node& node, F&& f) {
+    uint16_t published = node.bits.load(std::memory_order_acquire) >> PUBLISHED_SHIFT;
+
+    if (published & AGNOSTIC_BIT)
+        f(0, SearchResult{ node.agnostic_cost, node.agnostic_guess, node.agnostic_height });
+
+    for (int d = 1; d <= MAX_DEPTH; ++d)
+        if (published & (1u << d))
+            f(d, SearchResult{ node.specific_cost[d - 1], node.specific_guess[d - 1], 7 - d });
+}
+
+template <int N>
+size_t LockFreeMemo<N>::size() const {
+    size_t values = 0;
+    for (size_t i = 0; i <= mask; ++i) {
+        const Node* node = slots[i].load(std::memory_order_acquire);
+        if (node) values += __builtin_popcount(node->bits.load(std::memory_order_acquire) >> PUBLISHED_SHIFT);
+    }
+    return values;
+}
+
+template <int N>
+void LockFreeMemo<N>::for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const {
+    for (size_t i = 0; i <= mask; ++i) {
+        const Node* node = slots[i].load(std::memory_order_acquire);
+        if (node) visit(*node, [&](int depth, const SearchResult& res) { f(node->state, depth, res); });
+    }
+}
+
+// -- Persistence --
+
+// Layout is in MemoBackend.hpp. Chunked by slot range, since nothing needs locking
+template <int N>
+void LockFreeMemo<N>::save(std::ostream& out) const {
+    constexpr size_t CHUNK_SLOTS = 4096;
+    std::vector<char> buf;
+
+    for (bool agnostic : {true, false}) {
+        for (size_t start = 0; start <= mask; start += CHUNK_SLOTS) {
+            buf.clear();
+            uint64_t count = 0;
+
+            for (size_t i = start; i < std::min(start + CHUNK_SLOTS, mask + 1); ++i) {
+                const Node* node = slots[i].load(std::memory_order_acquire);
+                if (!node) continue;
+
+                visit(*node, [&](int depth, const SearchResult& res) {
+                    if (agnostic && depth == 0) {
+                        put_agnostic(buf, node->state, res.expected_cost, static_cast<int16_t>(res.best_guess_index),
+                                     static_cast<uint8_t>(res.max_height));
+                        count++;
+                    } else if (!agnostic && depth != 0) {
+                        put_specific(buf, node->state, static_cast<uint8_t>(depth), res.expected_cost,
+                                     static_cast<int16_t>(res.best_guess_index));
+                        count++;
+                    }
+                });
+            }
+            if (count != 0) write_chunk(out, count, buf);
+        }
+        write_chunk(out, 0, {});
+    }
+}
+
+template <int N>
+void LockFreeMemo<N>::load(std::istream& in) {
+    read_state_records<N>(in, [&](const StateBitset<N>& state, int depth, const SearchResult& result) {
+        insert(state, depth, result);
+    });
+}
+
+#define INSTANTIATE(W) template class LockFreeMemo<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
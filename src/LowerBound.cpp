@@ -0,0 +1,111 @@
+#include "LowerBound.hpp"
+#include "Profile.hpp"
+#include "Statistics.hpp"
+
+#include <algorithm>
+
+template <int N>
+LowerBound<N>::LowerBound(const Config& c, const Wordle& g)
+    : ClockBudget(static_cast<size_t>(c.bound_budget_mb) * 1024 * 1024, &SolverStats::bound_evictions), config(c), game(g) {
+    bucket_map.reserve(config.bound_reserve);
+    proven_map.reserve(config.bound_reserve);
+}
+
+template <int N>
+double LowerBound<N>::floor(int count, int depth) const {
+    if (depth > 6) return config.fail_cost;
+    if (count <= 1) return count;
+
+    // The guess costs 1, and every answer is still at least a singleton (cost 1) in the next state
+    // If that next state is already past 6, all it can do is fail
+    double floor = (depth + 2 > 6) ? 1 + config.fail_cost : 2.0;
+    return std::min(floor, UNSOLVED_COST);
+}
+
+template <int N>
+double LowerBound<N>::partition_bound(const StateBitset<N>& state, const GuessBitset& guesses, int depth) {
+    PROFILE_SCOPE(Phase::PartitionBound, depth);
+    int count = state.count();
+    if (depth > 6 || count <= 1) return floor(count, depth);
+
+    int buckets = max_buckets(state, guesses);
+    if (buckets <= 1) return UNSOLVED_COST; // Nothing splits it, so solve_state never beats its starting best
+
+    // With fewer buckets than answers, at least one of them holds 2+ and the rest can be singletons
+    int singletons = (buckets == count) ? count : buckets - 1;
+
+    // Same as evaluate_guess, the children are at depth + 2
+    double total = singletons * floor(1, depth + 2) + (count - singletons) * floor(2, depth + 2);
+    return std::min(1 + total / count, UNSOLVED_COST);
+}
+
+template <int N>
+int LowerBound<N>::max_buckets(const StateBitset<N>& state, const GuessBitset& guesses) {
+    int cached = 0;
+    bucket_map.modify_if(state, [&](auto& kv) {
+        cached = kv.second.buckets;
+        if (kv.second.credit < MAX_CREDIT) kv.second.credit++; // A hit earns a CLOCK credit
+    });
+    if (cached != 0) {
+        t_stats.bound_cache_hits++;
+        return cached;
+    }
+
+    int count = state.count();
+    int best = 1;
+
+    // The state as a list, so each guess only touches its answers and not every word of the bitset
+    static thread_local std::vector<int> active_indices;
+    active_indices.clear();
+    for (int i : state) active_indices.push_back(i);
+
+    // 243 bit pattern set, reused across guesses
+    std::array<uint64_t, (NUM_PATTERNS + 63) / 64> seen = {0};
+
+    for (int g : guesses) {
+        int buckets = 0;
+        for (int answer_index : active_indices) {
+            Pattern p = game.get_pattern_lookup(g, answer_index);
+            uint64_t bit = 1ULL << (p % 64);
+            if (!(seen[p / 64] & bit)) {
+                seen[p / 64] |= bit;
+                buckets++;
+            }
+        }
+        seen.fill(0);
+
+        best = std::max(best, buckets);
+        if (best == count) break; // Can't split any further than all singletons
+    }
+
+    t_stats.bounds_computed++;
+    emplace(bucket_map, bucket_hands, state, BucketEntry{ static_cast<uint8_t>(best), initial_credit(count) }, BUCKET_BYTES);
+    return best;
+}
+
+template <int N>
+std::optional<double> LowerBound<N>::get_proven(const StateBitset<N>& state, int depth) {
+    std::optional<double> result = std::nullopt;
+
+    proven_map.modify_if(ProvenKey{state, static_cast<uint8_t>(depth)}, [&](auto& kv) {
+        result = kv.second.bound;
+        if (kv.second.credit < MAX_CREDIT) kv.second.credit++;
+    });
+
+    return result;
+}
+
+template <int N>
+void LowerBound<N>::insert_proven(const StateBitset<N>& state, int depth, double bound) {
+    // Keep whichever proof is stronger
+    ProvenKey key {state, static_cast<uint8_t>(depth)};
+    bool is_new = proven_map.try_emplace_l(key,
+        [&](auto& kv) { kv.second.bound = std::max(kv.second.bound, bound); },
+        ProvenEntry{ bound, initial_credit(state.count()) });
+
+    if (is_new) added(proven_map, proven_hands, key, PROVEN_BYTES);
+}
+
+#define INSTANTIATE(W) template class LowerBound<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
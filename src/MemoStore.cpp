@@ -0,0 +1,204 @@
+#include "MemoStore.hpp"
+#include "MemoizationTable.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'W', 'R', 'D', 'L', 'S', 'T', 'O', 'R'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t TABLES_OFFSET = 64; // Header is padded out to a cache line
+
+// At most half full, so probe runs stay short
+size_t slots_for(size_t count) {
+    size_t slots = 1;
+    while (slots < count * 2) slots <<= 1;
+    return slots;
+}
+
+} // namespace
+
+template <int N>
+struct MemoStore<N>::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t state_width;
+    uint64_t words_hash;
+    uint64_t agnostic_slots;
+    uint64_t specific_slots;
+    uint64_t num_entries;
+};
+
+template <int N>
+MemoStore<N>::MemoStore(const std::string& path, const Wordle& game) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Couldn't open memo store " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < TABLES_OFFSET) {
+        ::close(fd);
+        throw std::runtime_error(path + " isn't a memo store");
+    }
+
+    mapping_size = static_cast<size_t>(info.st_size);
+    mapping = ::mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Couldn't map memo store " + path);
+    }
+    ::madvise(mapping, mapping_size, MADV_RANDOM); // Lookups are all over the place, so readahead is wasted
+
+    // From here on, the destructor won't run if the constructor throws
+    auto fail = [&](const std::string& why) {
+        ::munmap(mapping, mapping_size);
+        mapping = nullptr;
+        throw std::runtime_error(path + ": " + why);
+    };
+
+    const Header& header = *static_cast<const Header*>(mapping);
+    if (!std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic)) fail("not a memo store");
+    if (header.version != VERSION) fail("unsupported version " + std::to_string(header.version));
+    if (header.state_width != N || header.words_hash != game.word_list_hash()) fail("made with different word lists");
+
+    size_t expected = TABLES_OFFSET + header.agnostic_slots * sizeof(AgnosticRecord) + header.specific_slots * sizeof(SpecificRecord);
+    if (mapping_size != expected) fail("size doesn't match its header");
+
+    const char* base = static_cast<const char*>(mapping) + TABLES_OFFSET;
+    agnostic = reinterpret_cast<const AgnosticRecord*>(base);
+    specific = reinterpret_cast<const SpecificRecord*>(base + header.agnostic_slots * sizeof(AgnosticRecord));
+    agnostic_mask = header.agnostic_slots - 1;
+    specific_mask = header.specific_slots - 1;
+    num_entries = header.num_entries;
+}
+
+template <int N>
+MemoStore<N>::~MemoStore() {
+    if (mapping) ::munmap(mapping, mapping_size);
+}
+
+template <int N>
+std::optional<SearchResult> MemoStore<N>::get(const StateBitset<N>& state, int depth) const {
+    // Check Agnostic Table
+    for (size_t i = agnostic_hash(state) & agnostic_mask; agnostic[i].used; i = (i + 1) & agnostic_mask) {
+        const AgnosticRecord& rec = agnostic[i];
+        if (std::memcmp(rec.words, state.words, sizeof(rec.words)) != 0) continue;
+
+        if (depth + rec.max_subtree_height <= 6)
+            return SearchResult{ rec.expected_guesses, rec.best_guess_index, rec.max_subtree_height };
+        break;
+    }
+
+    // Check Specific Table
+    for (size_t i = specific_hash(state, depth) & specific_mask; specific[i].used; i = (i + 1) & specific_mask) {
+        const SpecificRecord& rec = specific[i];
+        if (rec.depth == depth && std::memcmp(rec.words, state.words, sizeof(rec.words)) == 0)
+            return SearchResult{ rec.expected_guesses, rec.best_guess_index, 7 - depth };
+    }
+
+    return std::nullopt;
+}
+
+template <int N>
+void MemoStore<N>::for_each(const std::function<void(const StateBitset<N>&, int, const SearchResult&)>& f) const {
+    StateBitset<N> state;
+
+    for (size_t i = 0; i <= agnostic_mask; ++i) {
+        if (!agnostic[i].used) continue;
+        std::memcpy(state.words, agnostic[i].words, sizeof(state.words));
+        f(state, 0, SearchResult{ agnostic[i].expected_guesses, agnostic[i].best_guess_index, agnostic[i].max_subtree_height });
+    }
+
+    for (size_t i = 0; i <= specific_mask; ++i) {
+        if (!specific[i].used) continue;
+        std::memcpy(state.words, specific[i].words, sizeof(state.words));
+        int depth = specific[i].depth;
+        f(state, depth, SearchResult{ specific[i].expected_guesses, specific[i].best_guess_index, 7 - depth });
+    }
+}
+
+template <int N>
+void MemoStore<N>::write(const std::string& path, const Wordle& game, const MemoizationTable<N>& table) {
+    // Split the same way MemoizationTable::insert does
+    std::vector<std::pair<StateBitset<N>, SearchResult>> clean;
+    std::vector<std::pair<StateBitset<N>, int>> tainted_keys;
+    std::vector<SearchResult> tainted;
+    table.for_each([&](const StateBitset<N>& state, int depth, const SearchResult& res) {
+        if (depth + res.max_height <= 6) {
+            clean.emplace_back(state, res);
+        } else {
+            tainted_keys.emplace_back(state, depth);
+            tainted.push_back(res);
+        }
+    });
+
+    Header header {};
+    std::copy(std::begin(MAGIC), std::end(MAGIC), header.magic);
+    header.version = VERSION;
+    header.state_width = N;
+    header.words_hash = game.word_list_hash();
+    header.agnostic_slots = slots_for(clean.size());
+    header.specific_slots = slots_for(tainted.size());
+    header.num_entries = clean.size() + tainted.size();
+
+    std::vector<AgnosticRecord> agnostic_table(header.agnostic_slots); // Value initialized, so unused slots are all 0
+    for (const auto& [state, res] : clean) {
+        size_t i = agnostic_hash(state) & (header.agnostic_slots - 1);
+        while (agnostic_table[i].used) i = (i + 1) & (header.agnostic_slots - 1);
+
+        AgnosticRecord& rec = agnostic_table[i];
+        std::memcpy(rec.words, state.words, sizeof(rec.words));
+        rec.expected_guesses = res.expected_cost;
+        rec.best_guess_index = static_cast<int16_t>(res.best_guess_index);
+        rec.max_subtree_height = static_cast<uint8_t>(res.max_height);
+        rec.used = 1;
+    }
+
+    std::vector<SpecificRecord> specific_table(header.specific_slots);
+    for (size_t t = 0; t < tainted.size(); ++t) {
+        const auto& [state, depth] = tainted_keys[t];
+        size_t i = specific_hash(state, depth) & (header.specific_slots - 1);
+        while (specific_table[i].used) i = (i + 1) & (header.specific_slots - 1);
+
+        SpecificRecord& rec = specific_table[i];
+        std::memcpy(rec.words, state.words, sizeof(rec.words));
+        rec.expected_guesses = tainted[t].expected_cost;
+        rec.best_guess_index = static_cast<int16_t>(tainted[t].best_guess_index);
+        rec.depth = static_cast<uint8_t>(depth);
+        rec.used = 1;
+    }
+
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) throw std::runtime_error("Couldn't open memo store " + temp_path);
+
+        char padded[TABLES_OFFSET] = {0};
+        static_assert(sizeof(Header) <= TABLES_OFFSET, "Header has to fit before the tables");
+        std::memcpy(padded, &header, sizeof(header));
+        out.write(padded, sizeof(padded));
+        out.write(reinterpret_cast<const char*>(agnostic_table.data()), static_cast<std::streamsize>(agnostic_table.size() * sizeof(AgnosticRecord)));
+        out.write(reinterpret_cast<const char*>(specific_table.data()), static_cast<std::streamsize>(specific_table.size() * sizeof(SpecificRecord)));
+
+        out.flush();
+        if (!out) throw std::runtime_error("Failed writing memo store " + temp_path);
+    }
+
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Couldn't move memo store into place at " + path);
+}
+
+#define INSTANTIATE(W) template class MemoStore<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
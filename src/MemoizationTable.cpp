@@ -1,65 +1,122 @@
 #include "MemoizationTable.hpp"
+#include "ExactMemo.hpp"
+#include "FingerprintMemo.hpp"
+#include "LockFreeMemo.hpp"
+#include "Profile.hpp"
 #include "Statistics.hpp"
 
-MemoizationTable::MemoizationTable(const Config& c) : config(c) {
-    agnostic_map.reserve(config.agnostic_reserve);
-    specific_map.reserve(config.specific_reserve);
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+
+template <int N>
+MemoizationTable<N>::MemoizationTable(const Config& c) : config(c) {
+    switch (config.memo_backend) {
+        case MemoBackendType::Fingerprint: backend = std::make_unique<FingerprintMemo<N>>(config); break;
+        case MemoBackendType::LockFree: backend = std::make_unique<LockFreeMemo<N>>(config); break;
+        default: backend = std::make_unique<ExactMemo<N>>(config); break;
+    }
 }
 
 
-std::optional<SearchResult> MemoizationTable::get(const StateBitset& state, int depth) {
-    std::optional<SearchResult> result = std::nullopt;
+template <int N>
+std::optional<SearchResult> MemoizationTable<N>::get(const StateBitset<N>& state, int depth) {
+    PROFILE_SCOPE(Phase::MemoGet, depth);
+    std::optional<SearchResult> result = backend->get(state, depth);
+    if (result || !store) return result;
 
-    // Check Agnostic Table
-    agnostic_map.if_contains(state, [&](const auto& kv) {
-        const AgnosticEntry& entry = kv.second;
+    // Check the on-disk store
+    result = store->get(state, depth);
+    if (result) t_stats.store_hits++;
+    return result;
+}
 
-        if (depth + entry.max_subtree_height <= 6) {
-            result = SearchResult{
-                entry.expected_guesses,
-                entry.best_guess_index,
-                entry.max_subtree_height
-            };
-        }
-    });
+template <int N>
+void MemoizationTable<N>::insert(const StateBitset<N>& state, int depth, const SearchResult& result) {
+    PROFILE_SCOPE(Phase::MemoInsert, depth);
+    MemoInsert inserted = backend->insert(state, depth, result);
 
-    if (result) return result;
+    t_stats.memo_inserts++;
+    if (inserted == MemoInsert::Present)
+        t_stats.memo_collisions++;
+}
 
-    // Check Specific Table
-    SpecificKey key{state, static_cast<uint8_t>(depth)};
+// -- In-flight Claims --
 
-    specific_map.if_contains(key, [&](const auto& kv) {
-        const SpecificEntry& entry = kv.second;
+template <int N>
+bool MemoizationTable<N>::try_claim(const StateBitset<N>& state, int depth) {
+    return claims.try_emplace(claim_key(state, depth), omp_get_thread_num()).second;
+}
 
-        result = SearchResult{
-            entry.expected_guesses,
-            entry.best_guess_index,
-            7 - depth 
-        };
-    });
+template <int N>
+void MemoizationTable<N>::release_claim(const StateBitset<N>& state, int depth) {
+    claims.erase(claim_key(state, depth));
+}
 
-    return result;
+template <int N>
+bool MemoizationTable<N>::is_claimed(const StateBitset<N>& state, int depth) const {
+    return claims.contains(claim_key(state, depth));
 }
 
-void MemoizationTable::insert(const StateBitset& state, int depth, const SearchResult& result) {
-    bool is_clean_value = (depth + result.max_height <= 6);
-    bool inserted = false;
-
-    if (is_clean_value) {
-        inserted = agnostic_map.try_emplace(state, AgnosticEntry{
-            result.expected_cost,
-            static_cast<int16_t>(result.best_guess_index),
-            static_cast<uint8_t>(result.max_height)
-        }).second;
-    } else {
-        SpecificKey key{state, static_cast<uint8_t>(depth)};
-        inserted = specific_map.try_emplace(key, SpecificEntry{
-            result.expected_cost,
-            static_cast<int16_t>(result.best_guess_index)
-        }).second;
+// -- Persistence --
+
+// Layout: uint32 state width, uint8 backend, then the backend's chunks
+template <int N>
+void MemoizationTable<N>::save(std::ostream& out) const {
+    uint32_t width = N;
+    uint8_t kind = static_cast<uint8_t>(config.memo_backend);
+    out.write(reinterpret_cast<const char*>(&width), sizeof(width));
+    out.write(reinterpret_cast<const char*>(&kind), sizeof(kind));
+
+    backend->save(out);
+
+    if (!out) throw std::runtime_error("Failed writing memo dump");
+}
+
+template <int N>
+void MemoizationTable<N>::load(std::istream& in) {
+    uint32_t width = 0;
+    if (!in.read(reinterpret_cast<char*>(&width), sizeof(width)) || width != N)
+        throw std::runtime_error("Memo dump is for " + std::to_string(width) + " bit states, not " + std::to_string(N));
+
+    uint8_t kind = 0;
+    if (!in.read(reinterpret_cast<char*>(&kind), sizeof(kind)))
+        throw std::runtime_error("Memo dump ends early");
+    // Exact and lock-free dumps share their records, so either loads into the other
+    auto format = [](MemoBackendType type) {
+        return type == MemoBackendType::LockFree ? MemoBackendType::Exact : type;
+    };
+    if (format(static_cast<MemoBackendType>(kind)) != format(config.memo_backend))
+        throw std::runtime_error("Memo dump is from the " + memo_backend_name(static_cast<MemoBackendType>(kind))
+                                 + " backend, not " + memo_backend_name(config.memo_backend));
+
+    backend->load(in);
+}
+
+MemoBackendType parse_memo_backend(const std::string& name) {
+    if (name == "exact") return MemoBackendType::Exact;
+    if (name == "fingerprint") return MemoBackendType::Fingerprint;
+    if (name == "lockfree") return MemoBackendType::LockFree;
+    throw std::runtime_error("Unknown memo backend " + name + " (expected exact, fingerprint or lockfree)");
+}
+
+std::string memo_backend_name(MemoBackendType type) {
+    switch (type) {
+        case MemoBackendType::Exact: return "exact";
+        case MemoBackendType::Fingerprint: return "fingerprint";
+        case MemoBackendType::LockFree: return "lockfree";
+        default: return "unknown (" + std::to_string(static_cast<int>(type)) + ")";
     }
+}
 
-    t_stats.memo_inserts++;
-    if (!inserted)
-        t_stats.memo_collisions++;
+ClaimPolicy parse_claim_policy(const std::string& name) {
+    if (name == "off") return ClaimPolicy::Off;
+    if (name == "wait") return ClaimPolicy::Wait;
+    if (name == "help") return ClaimPolicy::Help;
+    if (name == "defer") return ClaimPolicy::Defer;
+    throw std::runtime_error("Unknown claim policy " + name + " (expected off, wait, help or defer)");
 }
+
+#define INSTANTIATE(W) template class MemoizationTable<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,89 @@
+#include "Profile.hpp"
+
+#ifdef WORDLE_PROFILE
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+thread_local PhaseProfile t_profile;
+PhaseProfile g_profile;
+
+namespace {
+
+// Taken when the program loads, so the rate is averaged over the whole run
+const uint64_t start_tsc = __rdtsc();
+const auto start_time = std::chrono::steady_clock::now();
+
+double cycles_per_ns() {
+    uint64_t cycles = __rdtsc() - start_tsc;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+    return ns > 0 ? cycles / ns : 1.0;
+}
+
+const char* phase_name(int phase) {
+    switch (static_cast<Phase>(phase)) {
+        case Phase::PruneActions: return "Prune Actions";
+        case Phase::OrderGuesses: return "Order Guesses";
+        case Phase::Partition: return "Partition";
+        case Phase::PartitionBound: return "Partition Bound";
+        case Phase::SmallSolve: return "Small Solve";
+        case Phase::MemoGet: return "Memo Get";
+        case Phase::MemoInsert: return "Memo Insert";
+        case Phase::COUNT: break;
+    }
+    return "?";
+}
+
+} // namespace
+
+void PhaseProfile::operator+=(const PhaseProfile& other) {
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        for (int d = 0; d < NUM_DEPTHS; ++d) {
+            cycles[p][d] += other.cycles[p][d];
+            calls[p][d] += other.calls[p][d];
+        }
+    }
+    for (int b = 0; b < NUM_WAIT_BUCKETS; ++b) lock_waits[b] += other.lock_waits[b];
+    lock_wait_cycles += other.lock_wait_cycles;
+    uncontended_locks += other.uncontended_locks;
+}
+
+void PhaseProfile::print() const {
+    double rate = cycles_per_ns();
+    auto ms = [&](uint64_t c) { return c / rate / 1e6; };
+
+    std::cout << "\n=== PHASE PROFILE ===\n";
+    std::cout << "TSC:             " << std::fixed << std::setprecision(2) << rate << " GHz\n";
+    std::cout << std::left << std::setw(17) << "Phase" << std::right << std::setw(12) << "Calls" << std::setw(12) << "ms"
+              << std::setw(10) << "ns/call" << "   ms by depth 1-7\n";
+
+    for (int p = 0; p < NUM_PHASES; ++p) {
+        uint64_t total_cycles = 0, total_calls = 0;
+        for (int d = 0; d < NUM_DEPTHS; ++d) {
+            total_cycles += cycles[p][d];
+            total_calls += calls[p][d];
+        }
+        if (total_calls == 0) continue;
+
+        std::cout << std::left << std::setw(17) << phase_name(p) << std::right << std::setw(12) << total_calls
+                  << std::setw(12) << std::setprecision(1) << ms(total_cycles)
+                  << std::setw(10) << std::setprecision(0) << total_cycles / rate / total_calls << "  ";
+        for (int d = 1; d < NUM_DEPTHS; ++d) std::cout << " " << std::setprecision(1) << ms(cycles[p][d]);
+        std::cout << "\n";
+    }
+
+    uint64_t num_waits = 0;
+    for (uint64_t n : lock_waits) num_waits += n;
+    std::cout << "-------------------------\n";
+    std::cout << "Memo Locks:      " << uncontended_locks << " free, " << num_waits << " waited ("
+              << std::setprecision(1) << ms(lock_wait_cycles) << " ms)\n";
+    for (int b = 0; b < NUM_WAIT_BUCKETS; ++b) {
+        if (lock_waits[b] == 0) continue;
+        std::cout << "  - < " << std::setw(10) << std::setprecision(0) << static_cast<double>(2ull << b) / rate << " ns: "
+                  << lock_waits[b] << "\n";
+    }
+    std::cout << "=========================\n";
+}
+
+#endif
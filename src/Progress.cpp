@@ -0,0 +1,128 @@
+#include "Progress.hpp"
+
+#include <omp.h>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+thread_local ProgressLink t_progress;
+
+size_t current_rss_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0, resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) return 0;
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+namespace {
+
+// 1h02m03s, or 2m03s, or 3s
+std::string format_duration(double seconds) {
+    long s = static_cast<long>(seconds);
+    char buf[32];
+    if (s >= 3600) std::snprintf(buf, sizeof(buf), "%ldh%02ldm%02lds", s / 3600, s / 60 % 60, s % 60);
+    else if (s >= 60) std::snprintf(buf, sizeof(buf), "%ldm%02lds", s / 60, s % 60);
+    else std::snprintf(buf, sizeof(buf), "%lds", s);
+    return buf;
+}
+
+} // namespace
+
+ProgressReporter::ProgressReporter(const Config& c, int tickets, std::function<size_t()> memo, std::function<size_t()> bound,
+                                   int r)
+    : config(c), num_tickets(tickets), memo_bytes(std::move(memo)), bound_bytes(std::move(bound)), rank(r),
+      shards(new ProgressShard[omp_get_max_threads()]), num_shards(omp_get_max_threads()) {
+    if (!config.progress_json_path.empty()) {
+        std::string path = config.progress_json_path;
+        if (rank >= 0) path += "." + std::to_string(rank); // One file per rank, they'd interleave otherwise
+        json.open(path, std::ios::app);
+        if (!json.is_open()) throw std::runtime_error("Couldn't open progress file " + path);
+    }
+}
+
+void ProgressReporter::stop() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_signal.notify_one();
+    thread.join();
+}
+
+void ProgressReporter::attach(int thread_num) {
+    t_progress = ProgressLink();
+    if (thread_num < num_shards) t_progress.shard = &shards[thread_num]; // Only threads beyond the max can miss out
+    publish_progress();
+}
+
+void ProgressReporter::start() {
+    if (config.stats_print_freq <= 0) return;
+    start_time = last_time = std::chrono::steady_clock::now();
+    thread = std::thread([this]() { run(); });
+}
+
+void ProgressReporter::run() {
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (!stop_signal.wait_for(lock, std::chrono::seconds(config.stats_print_freq), [this]() { return stopping; }))
+        report();
+    report(); // Where it ended up
+}
+
+void ProgressReporter::report() {
+    long nodes = 0, hits = 0, misses = 0;
+    for (int t = 0; t < num_shards; ++t) {
+        nodes += shards[t].nodes.load(std::memory_order_relaxed);
+        hits += shards[t].cache_hits.load(std::memory_order_relaxed);
+        misses += shards[t].cache_misses.load(std::memory_order_relaxed);
+    }
+    int done = tickets_done.load(std::memory_order_relaxed);
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - start_time).count();
+    double interval = std::chrono::duration<double>(now - last_time).count();
+    double nodes_per_s = interval > 0 ? (nodes - last_nodes) / interval : 0.0;
+    last_time = now;
+    last_nodes = nodes;
+
+    double hit_rate = hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0;
+    double memo_mb = memo_bytes() / (1024.0 * 1024.0);
+    double bound_mb = bound_bytes() / (1024.0 * 1024.0);
+    double rss_mb = current_rss_bytes() / (1024.0 * 1024.0);
+    bool has_eta = num_tickets > 0 && done > 0;
+    double eta = has_eta ? elapsed * (num_tickets - done) / done : 0.0;
+
+    std::ostringstream line;
+    line.setf(std::ios::fixed);
+    line.precision(1);
+    if (rank >= 0) line << "[rank " << rank << "] ";
+    line << "[progress] " << done;
+    if (num_tickets > 0) line << "/" << num_tickets << " openers (" << 100.0 * done / num_tickets << "%)";
+    else line << " openers";
+    line << ", " << nodes_per_s / 1000.0 << "k nodes/s, hits " << hit_rate << "%, memo " << memo_mb << " MB, bounds "
+         << bound_mb << " MB, rss " << rss_mb << " MB, elapsed " << format_duration(elapsed);
+    if (has_eta) line << ", ETA " << format_duration(eta);
+    line << "\n";
+
+    #pragma omp critical
+    std::cout << line.str() << std::flush;
+
+    if (json.is_open()) {
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        out << "{\"elapsed_s\": " << elapsed;
+        if (rank >= 0) out << ", \"rank\": " << rank;
+        out << ", \"tickets_done\": " << done << ", \"tickets\": " << num_tickets << ", \"nodes\": " << nodes
+            << ", \"nodes_per_s\": " << nodes_per_s << ", \"cache_hits\": " << hits << ", \"cache_misses\": " << misses
+            << ", \"hit_rate\": " << hit_rate << ", \"memo_mb\": " << memo_mb << ", \"bound_mb\": " << bound_mb
+            << ", \"rss_mb\": " << rss_mb
+            << ", \"eta_s\": ";
+        if (has_eta) out << eta;
+        else out << "null";
+        out << "}\n";
+        json << out.str() << std::flush;
+    }
+}
@@ -1,51 +1,276 @@
 #include "Solver.hpp"
 #include "Definitions.hpp"
 #include "MemoizationTable.hpp"
+#include "Profile.hpp"
+#include "Progress.hpp"
 #include "Statistics.hpp"
 #include "Wordle.hpp"
 
 #include <omp.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 
 thread_local SolverStats t_stats;
 
-Solver::Solver(const Config& c, const Wordle& g, MemoizationTable& m) : config(c), game(g), cache(m) {}
+namespace {
+
+// Reusable per thread scratch, handed out as a stack so the recursion never allocates once it's warmed up
+// One per depth isn't enough with tasks, since a thread waiting on its subtasks can run other tasks (at any depth)
+// on top of its own frames. Tied tasks keep that nesting LIFO, and so do the leases, since they're scoped locals
+template <typename T>
+class Scratch {
+public:
+    Scratch() {
+        if (used == frames.size())
+            frames.push_back(std::make_unique<T>());
+        value = frames[used++].get();
+    }
+    ~Scratch() { used--; }
+
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    T& operator*() const { return *value; }
+    T* operator->() const { return value; }
+
+private:
+    static thread_local std::vector<std::unique_ptr<T>> frames;
+    static thread_local size_t used;
+    T* value;
+};
+
+template <typename T>
+thread_local std::vector<std::unique_ptr<T>> Scratch<T>::frames;
+template <typename T>
+thread_local size_t Scratch<T>::used = 0;
+
+// solve_state's guesses. The list keeps its capacity between leases
+struct GuessScratch {
+    GuessBitset useful;
+    std::vector<int> order;
+};
+
+// In-flight claims this thread holds, and how many of them are below the task it's running now
+// A task run on top of unrelated frames (at an implicit task's taskwait or barrier, or a Help taskyield) never waits,
+// since the claim it waits on could be waiting on those frames. Otherwise a wait is always on a deeper claim than
+// anything the waiter holds, so waits can't form a cycle
+thread_local int t_claims_held = 0;
+thread_local int t_claims_below = 0;
+
+} // namespace
+
+template <int N>
+Solver<N>::Solver(const Config& c, const Wordle& g, MemoizationTable<N>& m, LowerBound<N>& b) : config(c), game(g), cache(m), bounds(b) {}
 
 // -- Public --
 
-SearchResult Solver::evaluate_guess(const StateBitset& state, int guess_ind, const GuessBitset& useful_guesses, int depth) {
-    std::array<int, NUM_PATTERNS> pattern_count = {0};
+template <int N>
+SearchResult Solver<N>::evaluate_guess(const StateBitset<N>& state, int guess_ind, const GuessBitset& useful_guesses, int depth, double budget) {
+    Scratch<Partition<N>> scratch;
+    Partition<N>& partition = *scratch;
+
+    {
+        PROFILE_SCOPE(Phase::Partition, depth);
+        game.partition_state(state, guess_ind, partition);
+    }
+
+    const auto& pattern_count = partition.counts;
+    int active_count = state.count();
+
+    // Branch and bound: the cheapest each bucket could possibly be, and the sum of those not yet searched
+    std::array<double, NUM_PATTERNS> bucket_floor;
+    double remaining_floor = 0.0;
+    if (config.enable_cutoffs) {
+        for (int i = 0; i < partition.num_patterns; ++i) {
+            Pattern p = partition.patterns[i];
+            bucket_floor[p] = pattern_count[p] * bounds.floor(pattern_count[p], depth + 1);
+            remaining_floor += bucket_floor[p];
+        }
+    }
+
+    // Largest total_cost this guess can reach and still be within budget. Slack keeps exact ties from being cut
+    double cost_limit = root_limit((budget - 1) * active_count + 1e-9, active_count, depth);
+
+    // The plain floors didn't settle it, so tighten the big buckets with their partition bounds
+    if (config.enable_cutoffs && config.partition_bounds && remaining_floor <= cost_limit) {
+        for (int i = 0; i < partition.num_patterns; ++i) {
+            Pattern p = partition.patterns[i];
+            if (pattern_count[p] < 2) continue;
+            double tighter = pattern_count[p] * bounds.partition_bound(partition.buckets[p], useful_guesses, depth + 1);
+            remaining_floor += tighter - bucket_floor[p];
+            bucket_floor[p] = tighter;
+        }
+    }
 
-    for (int answer_index : state) // This is builtin optimized
-        pattern_count[game.get_pattern_lookup(guess_ind, answer_index)]++;
+    // Shallow and big enough to be worth splitting across the team
+    if (depth <= config.task_depth && active_count >= config.task_min_size && omp_in_parallel()
+        && !(config.enable_cutoffs && remaining_floor > cost_limit))
+        return evaluate_tasks(partition, active_count, guess_ind, useful_guesses, depth, bucket_floor, remaining_floor, cost_limit);
 
     double total_cost = 0.0;
     int max_height = 0;
 
-    for (int p = 0; p < NUM_PATTERNS; ++p) {
-        if (pattern_count[p] == 0) continue;
+    // Buckets another thread is already solving go to the back, by which point they're likely in the memo
+    bool defer = (config.claim_policy == ClaimPolicy::Defer);
+    std::array<Pattern, NUM_PATTERNS> deferred;
+    std::array<double, NUM_PATTERNS> bucket_cost;
+    int num_deferred = 0;
+
+    for (int i = 0; i < partition.num_patterns + num_deferred; ++i) {
+        bool first_pass = (i < partition.num_patterns);
+        Pattern p = first_pass ? partition.patterns[i] : deferred[i - partition.num_patterns];
+
+        // Exact costs so far plus the floors of the rest already can't beat the budget
+        cost_limit = root_limit(cost_limit, active_count, depth);
+        if (config.enable_cutoffs && total_cost + remaining_floor > cost_limit) {
+            t_stats.cutoffs++;
+            return { 1 + (total_cost + remaining_floor) / active_count, guess_ind, max_height + 1, true };
+        }
+
+        if (first_pass && defer && pattern_count[p] >= config.claim_min_size && cache.is_claimed(partition.buckets[p], depth + 1)) {
+            deferred[num_deferred++] = p;
+            t_stats.claim_defers++;
+            continue;
+        }
+
+        if (config.enable_cutoffs) remaining_floor -= bucket_floor[p];
 
-        StateBitset new_state = game.prune_state(state, guess_ind, p);
+        // Without deep cutoffs, children are always solved exactly so they stay cacheable
+        double child_budget = (config.enable_cutoffs && config.deep_cutoffs)
+            ? (cost_limit - total_cost - remaining_floor) / pattern_count[p]
+            : NO_BUDGET;
 
         // Recursive
-        SearchResult new_state_res = solve_state(new_state, useful_guesses, depth + 1);
+        SearchResult new_state_res = solve_state(partition.buckets[p], useful_guesses, depth + 1, child_budget);
 
-        total_cost += new_state_res.expected_cost * pattern_count[p];
+        bucket_cost[p] = new_state_res.expected_cost * pattern_count[p];
+        total_cost += bucket_cost[p];
         max_height = std::max(max_height, new_state_res.max_height);
+
+        // Child is over its share, so its bound already puts this guess over budget
+        if (new_state_res.is_cut) {
+            t_stats.cutoffs++;
+            return { 1 + (total_cost + remaining_floor) / active_count, guess_ind, max_height + 1, true };
+        }
+    }
+
+    // Deferred buckets were added out of order, so sum again in pattern order to match the plain loop bit for bit
+    if (num_deferred != 0) {
+        total_cost = 0.0;
+        for (int i = 0; i < partition.num_patterns; ++i)
+            total_cost += bucket_cost[partition.patterns[i]];
     }
 
     // Result for THIS guess, so the guess_ind is just this
-    return { 1 + (total_cost / state.count()), guess_ind, max_height + 1 };
+    return { 1 + (total_cost / active_count), guess_ind, max_height + 1 };
 } // TODO: If I can make solve_state clean enough, it's probably cleanest to have it all in solve_state
 
 // -- Private Primary --
 
-SearchResult Solver::solve_state(const StateBitset& state, const GuessBitset& remaining_guesses, int depth) {
+template <int N>
+SearchResult Solver<N>::evaluate_tasks(const Partition<N>& partition, int active_count, int guess_ind, const GuessBitset& useful_guesses,
+                                       int depth, const std::array<double, NUM_PATTERNS>& bucket_floor, double floor_total, double cost_limit) {
+    t_stats.tasks_split++;
+
+    const auto& pattern_count = partition.counts;
+    std::array<SearchResult, NUM_PATTERNS> results;
+    std::array<bool, NUM_PATTERNS> solved = {false};
+
+    // Budgets can't follow the running total like the serial loop, so the exact costs found so far are shared instead.
+    // excess is how far above their floors the solved buckets came out, and once floors + excess is over the limit it's cut
+    double excess = 0.0;
+    std::atomic<bool> cut {false};
+
+    auto solve_bucket = [&](Pattern p) {
+        if (cut.load(std::memory_order_relaxed)) return;
+
+        // Assumes every other bucket lands on its floor, which is the most this one could ever get
+        double child_budget = (config.enable_cutoffs && config.deep_cutoffs)
+            ? (root_limit(cost_limit, active_count, depth) - (floor_total - bucket_floor[p])) / pattern_count[p]
+            : NO_BUDGET;
+
+        SearchResult res = solve_state(partition.buckets[p], useful_guesses, depth + 1, child_budget);
+        results[p] = res;
+        solved[p] = true;
+
+        if (!config.enable_cutoffs) return;
+
+        double over = res.expected_cost * pattern_count[p] - bucket_floor[p];
+        double total_excess;
+        #pragma omp atomic capture
+        total_excess = excess += over;
+
+        if (res.is_cut || floor_total + total_excess > root_limit(cost_limit, active_count, depth))
+            cut.store(true, std::memory_order_relaxed);
+    };
+
+    // Big buckets go to the team, and this thread takes the small ones itself while they run
+    for (int i = 0; i < partition.num_patterns; ++i) {
+        Pattern p = partition.patterns[i];
+        if (pattern_count[p] < config.task_min_size) continue;
+
+        #pragma omp task firstprivate(p) shared(solve_bucket)
+        {
+            // Whatever this thread was doing before picking the task up is below it now
+            int below = t_claims_below;
+            t_claims_below = t_claims_held;
+            solve_bucket(p);
+            t_claims_below = below;
+        }
+    }
+
+    for (int i = 0; i < partition.num_patterns; ++i) {
+        Pattern p = partition.patterns[i];
+        if (pattern_count[p] < config.task_min_size) solve_bucket(p);
+    }
+
+    #pragma omp taskwait
+
+    // Joined in pattern order, so the sum is the same as the serial loop's
+    double total_cost = 0.0;
+    double lower_bound = 0.0; // Unsolved buckets at their floors, only used if it was cut
+    int max_height = 0;
+    for (int i = 0; i < partition.num_patterns; ++i) {
+        Pattern p = partition.patterns[i];
+        if (!solved[p]) {
+            lower_bound += bucket_floor[p];
+            continue;
+        }
+        total_cost += results[p].expected_cost * pattern_count[p];
+        max_height = std::max(max_height, results[p].max_height);
+    }
+
+    if (cut.load()) {
+        t_stats.cutoffs++;
+        return { 1 + (total_cost + lower_bound) / active_count, guess_ind, max_height + 1, true };
+    }
+
+    return { 1 + (total_cost / active_count), guess_ind, max_height + 1 };
+}
+
+template <int N>
+SearchResult Solver<N>::solve_state(const StateBitset<N>& state, const GuessBitset& remaining_guesses, int depth, double budget) {
     t_stats.nodes_visited++;
+    if ((t_stats.nodes_visited & (PUBLISH_EVERY - 1)) == 0) publish_progress();
 
     if (depth > 6) return { config.fail_cost, -1, 0 }; 
     int active_count = state.count();
     if (active_count == 1) return { 1.0, -1, 1 }; // -1 because no guess needed
     if (active_count == 0) return { 0.0, -1, 0 };
+
+    // Cheaper to solve outright than to look up, and not worth a memo entry
+    if (active_count <= std::min(config.small_state_max, MAX_SMALL_STATE)) {
+        t_stats.small_solves++;
+        std::array<int, MAX_SMALL_STATE> answers;
+        int count = 0;
+        for (int i : state) answers[count++] = i;
+        PROFILE_SCOPE(Phase::SmallSolve, depth);
+        return solve_small(answers.data(), count, remaining_guesses, depth);
+    }
  
     // Cache Check
     if (auto entry = cache.get(state, depth)) {
@@ -54,36 +279,244 @@ SearchResult Solver::solve_state(const StateBitset& state, const GuessBitset& re
     }
     t_stats.cache_misses++;
 
-    GuessBitset useful_guesses = prune_actions(state, remaining_guesses);
+    // Claim it, or let whoever already has it finish. Only unbudgeted solves are claimed, since those always get cached
+    bool claimed = false;
+    if (config.claim_policy != ClaimPolicy::Off && budget == NO_BUDGET && active_count >= config.claim_min_size) {
+        while (!(claimed = cache.try_claim(state, depth)) && t_claims_below == 0) {
+            if (auto entry = await_claim(state, depth)) {
+                t_stats.claim_waits++;
+                return *entry;
+            }
+            // Released with nothing in the memo (a hash collision, or evicted already), so try to claim it again
+        }
+    }
+    if (claimed) t_claims_held++;
+
+    // Released after the insert below, so waiters find the result
+    struct ClaimRelease {
+        MemoizationTable<N>* cache;
+        const StateBitset<N>& state;
+        int depth;
+        ~ClaimRelease() {
+            if (!cache) return;
+            cache->release_claim(state, depth);
+            t_claims_held--;
+        }
+    } release { claimed ? &cache : nullptr, state, depth };
+
+    // Only has a budget with deep cutoffs. Skip the search entirely if it provably can't meet it
+    if (budget != NO_BUDGET) {
+        double bound = bounds.get_proven(state, depth).value_or(0.0);
+        if (config.partition_bounds)
+            bound = std::max(bound, bounds.partition_bound(state, remaining_guesses, depth));
+
+        if (bound > budget) {
+            t_stats.bound_prunes++;
+            return { bound, -1, 0, true };
+        }
+    }
+
+    Scratch<GuessScratch> scratch;
+    const GuessBitset& useful_guesses = scratch->useful;
+    {
+        PROFILE_SCOPE(Phase::PruneActions, depth);
+        prune_actions(state, remaining_guesses, scratch->useful);
+    }
 
     // Track the best result found in this loop
-    SearchResult best_res { 1000.0, -1, 1000 }; 
+    SearchResult best_res { UNSOLVED_COST, -1, 1000 };
+    double cut_bound = NO_BUDGET; // Smallest lower bound of the guesses that were cut
 
-    std::vector<int> guess_inds;
-    guess_inds.reserve(useful_guesses.count());
-    for (int g = 0; g < NUM_GUESSES; ++g)
-        if (useful_guesses.test(g)) guess_inds.push_back(g);
+    std::vector<int>& guess_inds = scratch->order;
+    guess_inds.clear();
+    for (int g : useful_guesses) // builtin optimized, only active inds
+        guess_inds.push_back(g);
+
+    {
+        PROFILE_SCOPE(Phase::OrderGuesses, depth);
+        order_guesses(state, guess_inds);
+    }
 
     for (int g : guess_inds) {
-        // Recursive
-        SearchResult res = evaluate_guess(state, g, useful_guesses, depth + 1);
+        // Recursive. Only has to beat the best sibling so far (or whatever the caller can afford)
+        SearchResult res = evaluate_guess(state, g, useful_guesses, depth + 1, std::min(budget, best_res.expected_cost));
+
+        if (res.is_cut) {
+            cut_bound = std::min(cut_bound, res.expected_cost);
+            continue;
+        }
 
         if (res.expected_cost < best_res.expected_cost)
             best_res = res;
     }
 
+    // Over the caller's budget with guesses that were never fully searched, so this is only a lower bound
+    // Never cache it as exact, but remember the proof so the next visit can skip straight to it
+    if (best_res.expected_cost > budget && cut_bound != NO_BUDGET) {
+        double bound = std::min(best_res.expected_cost, cut_bound);
+        bounds.insert_proven(state, depth, bound);
+        t_stats.proven_inserts++;
+        return { bound, -1, 0, true };
+    }
+
+    // Otherwise every cut guess is provably worse than best_res, so it's exact and safe to cache
+
     // Cache save
     cache.insert(state, depth, best_res);
 
     return best_res;
 }
 
+template <int N>
+SearchResult Solver<N>::solve_small(const int* answers, int count, const GuessBitset& guesses, int depth) {
+    if (depth > 6) return { config.fail_cost, -1, 0 };
+    if (count == 1) return { 1.0, -1, 1 };
+    if (count == 0) return { 0.0, -1, 0 };
+
+    SearchResult best_res { UNSOLVED_COST, -1, 1000 };
+
+    // Partitions already tried, as each answer's bucket numbered by first appearance (3 bits each)
+    // At most Bell(5) = 52 of them
+    std::array<uint32_t, 64> tried;
+    int num_tried = 0;
+
+    for (int g : guesses) {
+        std::array<Pattern, MAX_SMALL_STATE> patterns;
+        std::array<Pattern, MAX_SMALL_STATE> firsts; // Pattern of each bucket, in first appearance order
+        uint32_t key = 0;
+        int num_buckets = 0;
+
+        for (int i = 0; i < count; ++i) {
+            patterns[i] = game.get_pattern_lookup(g, answers[i]);
+            int bucket = 0;
+            while (bucket < num_buckets && firsts[bucket] != patterns[i]) bucket++;
+            if (bucket == num_buckets) firsts[num_buckets++] = patterns[i];
+            key |= static_cast<uint32_t>(bucket) << (3 * i);
+        }
+
+        if (num_buckets == 1) continue; // Useless guess
+        if (std::find(tried.begin(), tried.begin() + num_tried, key) != tried.begin() + num_tried) continue;
+        tried[num_tried++] = key;
+
+        // Buckets in ascending pattern order, summed the same way evaluate_guess does
+        // Insertion sort, since it's at most 5 long (and std::sort over the fixed array trips -Warray-bounds)
+        std::array<int, MAX_SMALL_STATE> order;
+        for (int i = 0; i < count; ++i) {
+            int j = i;
+            for (; j > 0 && patterns[order[j - 1]] > patterns[i]; --j) order[j] = order[j - 1];
+            order[j] = i;
+        }
+
+        double total_cost = 0.0;
+        int max_height = 0;
+        for (int start = 0; start < count;) {
+            int end = start;
+            std::array<int, MAX_SMALL_STATE> bucket;
+            while (end < count && patterns[order[end]] == patterns[order[start]]) {
+                bucket[end - start] = answers[order[end]];
+                end++;
+            }
+
+            // + 2 like evaluate_guess then solve_state, so the depth limit lands in the same place
+            SearchResult child = solve_small(bucket.data(), end - start, guesses, depth + 2);
+            total_cost += child.expected_cost * (end - start);
+            max_height = std::max(max_height, child.max_height);
+            start = end;
+        }
+
+        SearchResult res { 1 + total_cost / count, g, max_height + 1 };
+        if (res.expected_cost < best_res.expected_cost)
+            best_res = res;
+
+        // All singletons is the floor, so no other guess can do better
+        if (num_buckets == count) break;
+    }
+
+    return best_res;
+}
+
+template <int N>
+double Solver<N>::root_limit(double cost_limit, int active_count, int depth) const {
+    if (depth != 1 || !root_budget) return cost_limit;
+    return std::min(cost_limit, (root_budget->load(std::memory_order_relaxed) - 1) * active_count + 1e-9);
+}
+
+template <int N>
+std::optional<SearchResult> Solver<N>::await_claim(const StateBitset<N>& state, int depth) {
+    while (cache.is_claimed(state, depth)) {
+        if (config.claim_policy == ClaimPolicy::Help) {
+            #pragma omp taskyield
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return cache.get(state, depth);
+}
+
+template <int N>
+void Solver<N>::order_guesses(const StateBitset<N>& state, std::vector<int>& guess_inds) {
+    if (config.guess_order == GuessOrder::Index || guess_inds.size() < 2) return;
+
+    struct Scored {
+        double score; // Lower is searched first
+        int guess_index;
+    };
+
+    static thread_local std::vector<Scored> scored;
+    scored.clear();
+    scored.reserve(guess_inds.size());
+
+    std::array<int, NUM_PATTERNS> pattern_count;
+
+    for (int g : guess_inds) {
+        game.count_patterns(state, g, pattern_count);
+
+        double score = 0.0;
+        switch (config.guess_order) {
+            case GuessOrder::BucketCount:
+                for (int c : pattern_count) score -= (c != 0);
+                break;
+            case GuessOrder::LargestBucket:
+                for (int c : pattern_count) score = std::max<double>(score, c);
+                break;
+            case GuessOrder::Entropy:
+                // Negative entropy, dropping the constant log(n) term: sum of c * log(c)
+                for (int c : pattern_count) if (c > 1) score += c * std::log2(c);
+                break;
+            case GuessOrder::Index:
+                break;
+        }
+
+        scored.push_back({score, g});
+    }
+
+    // Ties stay in index order so the search is still deterministic
+    auto better = [](const Scored& a, const Scored& b) {
+        return a.score < b.score || (a.score == b.score && a.guess_index < b.guess_index);
+    };
+
+    size_t k = config.order_top_k > 0 ? std::min<size_t>(config.order_top_k, scored.size()) : scored.size();
+    if (k == scored.size()) {
+        std::sort(scored.begin(), scored.end(), better);
+    } else {
+        // Top k to the front, and the rest go back to index order behind them
+        std::nth_element(scored.begin(), scored.begin() + k, scored.end(), better);
+        std::sort(scored.begin(), scored.begin() + k, better);
+        std::sort(scored.begin() + k, scored.end(),
+            [](const Scored& a, const Scored& b) { return a.guess_index < b.guess_index; });
+    }
+
+    for (size_t i = 0; i < scored.size(); ++i)
+        guess_inds[i] = scored[i].guess_index;
+}
+
 // Simple FNV-1a style hash combiner
 inline size_t combine_hash(size_t hash, uint8_t value) {
     return (hash ^ value) * 1099511628211ULL;
 }
 
-GuessBitset Solver::prune_actions(const StateBitset& state, const GuessBitset& curr_guesses) {
+template <int N>
+void Solver<N>::prune_actions(const StateBitset<N>& state, const GuessBitset& curr_guesses, GuessBitset& useful_guesses) {
     t_stats.prune_function_calls++;
 
     static thread_local std::vector<int> active_indices;
@@ -93,32 +526,53 @@ GuessBitset Solver::prune_actions(const StateBitset& state, const GuessBitset& c
     for (int i : state) // builtin optimized, only active inds
         active_indices.push_back(i);
 
+    // Up to 8 patterns pack into the signature as is, so equal signatures are equal guesses with no re-check
+    bool exact_signature = active_indices.size() <= 8;
 
-    struct Candidate {
-        size_t signature_hash;
+    // Open addressing table of the classes found so far, one slot per class holding its first (lowest) guess
+    // Stamped rather than cleared, since the small states call this far more often than they fill it
+    struct ClassSlot {
+        uint64_t signature;
         int guess_index;
+        uint32_t stamp;
     };
 
-    static thread_local std::vector<Candidate> candidates;
-    candidates.clear();
-    candidates.reserve(NUM_GUESSES);
+    static thread_local std::vector<ClassSlot> classes;
+    static thread_local uint32_t stamp = 0;
+
+    size_t num_slots = 16;
+    while (num_slots < 2 * static_cast<size_t>(curr_guesses.count())) num_slots <<= 1;
+    if (classes.size() < num_slots) {
+        classes.assign(num_slots, ClassSlot{ 0, -1, 0 });
+        stamp = 0;
+    }
+    if (++stamp == 0) { // Wrapped, so old stamps could match again
+        std::fill(classes.begin(), classes.end(), ClassSlot{ 0, -1, 0 });
+        stamp = 1;
+    }
+    int shift = 64 - __builtin_ctzll(num_slots);
+
+    bool dominance = (config.dominance != DominancePolicy::Off);
+    static thread_local std::vector<Representative> representatives;
+    representatives.clear();
 
     for (int g : curr_guesses) { // builtin optimized, only active inds
         t_stats.total_actions_checked++;
 
-        size_t hash = 14695981039346656037ULL; // FNV offset basis
+        uint64_t signature = exact_signature ? 0 : 14695981039346656037ULL; // FNV offset basis
         bool all_same = true;
+        std::array<uint64_t, 4> seen = {0}; // Which patterns came up, for the dominance stage
 
         // First pattern for uselessness check
         Pattern first_p = game.get_pattern_lookup(g, active_indices[0]);
-        hash = combine_hash(hash, first_p);
 
         // Compute Signature
-        for (size_t i = 1; i < active_indices.size(); ++i) {
+        for (size_t i = 0; i < active_indices.size(); ++i) {
             Pattern p = game.get_pattern_lookup(g, active_indices[i]);
  
             if (p != first_p) all_same = false;
-            hash = combine_hash(hash, p);
+            signature = exact_signature ? (signature << 8) | p : combine_hash(signature, p);
+            if (dominance) seen[p >> 6] |= 1ull << (p & 63);
         }
 
         if (all_same) {
@@ -127,47 +581,110 @@ GuessBitset Solver::prune_actions(const StateBitset& state, const GuessBitset& c
         }
         // TODO: It's useless when all eliminate nothing. Is this equivelent?
 
-        candidates.push_back({hash, g});
+        // Guesses come in index order, so each class keeps its lowest guess
+        bool is_duplicate = false;
+        size_t slot = static_cast<size_t>((signature * 0x9e3779b97f4a7c15ull) >> shift);
+        for (;; slot = (slot + 1) & (num_slots - 1)) {
+            ClassSlot& c = classes[slot];
+            if (c.stamp != stamp) {
+                c = ClassSlot{ signature, g, stamp };
+                break;
+            }
+            if (c.signature != signature) continue;
+
+            // Collision Check
+            is_duplicate = true;
+            if (!exact_signature) {
+                for (int answer_idx : active_indices) {
+                    if (game.get_pattern_lookup(g, answer_idx) != game.get_pattern_lookup(c.guess_index, answer_idx)) {
+                        is_duplicate = false;
+                        break;
+                    }
+                }
+            }
+            if (is_duplicate) break;
+        }
+
+        if (is_duplicate) {
+            t_stats.duplicates_pruned++;
+            continue;
+        }
+
+        int num_buckets = 0;
+        for (uint64_t word : seen) num_buckets += __builtin_popcountll(word);
+        representatives.push_back({ num_buckets, g });
     }
 
-    // Sort the hashes
-    std::sort(candidates.begin(), candidates.end(), 
-        [](const Candidate& a, const Candidate& b) {
-            return a.signature_hash < b.signature_hash;
-        });
+    if (dominance) drop_dominated(active_indices, representatives);
 
-    GuessBitset useful_guesses;
-    if (candidates.empty()) return useful_guesses; // TODO: When could this happen?
+    useful_guesses.reset();
+    for (const Representative& r : representatives)
+        useful_guesses.set(r.guess_index);
 
-    // Pass with handling
-    useful_guesses.set(candidates[0].guess_index);
+    t_stats.total_actions_kept += representatives.size();
+}
 
-    for (size_t i = 1; i < candidates.size(); ++i) {
-        // If hashes are different, it's definitely a different signature
-        if (candidates[i].signature_hash != candidates[i-1].signature_hash) {
-            useful_guesses.set(candidates[i].guess_index);
-            continue;
+// A guess whose partition another guess refines (splits every bucket of it the same way or further) can't do better,
+// since the finer guess can always play the coarser one's subtree strategy on each of its smaller buckets.
+// A singleton costs 1 whichever guess made it, so the all green bucket isn't special. Dominance also holds in every
+// child state, since both are handed the same guesses and refining survives dropping answers
+template <int N>
+void Solver<N>::drop_dominated(const std::vector<int>& active_indices, std::vector<Representative>& representatives) {
+    if (representatives.size() < 2) return;
+
+    // Finest first, so anything that could refine a guess was already kept (or dropped for something finer still)
+    std::sort(representatives.begin(), representatives.end(), [](const Representative& a, const Representative& b) {
+        return a.num_buckets > b.num_buckets || (a.num_buckets == b.num_buckets && a.guess_index < b.guess_index);
+    });
+
+    // Whether fine's buckets each sit inside one of coarse's
+    auto refines = [&](int fine, int coarse) {
+        std::array<int16_t, NUM_PATTERNS> coarse_of;
+        coarse_of.fill(-1);
+        for (int answer_idx : active_indices) {
+            Pattern f = game.get_pattern_lookup(fine, answer_idx);
+            Pattern c = game.get_pattern_lookup(coarse, answer_idx);
+            if (coarse_of[f] == -1) coarse_of[f] = c;
+            else if (coarse_of[f] != c) return false;
         }
+        return true;
+    };
 
-        // Collision Check
-        bool is_duplicate = true;
-        int g1 = candidates[i].guess_index;
-        int g2 = candidates[i-1].guess_index;
+    size_t width = (config.dominance == DominancePolicy::Approximate)
+        ? static_cast<size_t>(std::max(config.dominance_width, 0))
+        : representatives.size();
 
-        for (int answer_idx : active_indices) {
-            if (game.get_pattern_lookup(g1, answer_idx) != game.get_pattern_lookup(g2, answer_idx)) {
-                is_duplicate = false;
-                break;
-            }
-        } // TODO: Explore tradeoff of keeping all in memory from the start and avoiding this
+    size_t num_kept = 1;
+    for (size_t i = 1; i < representatives.size(); ++i) {
+        const Representative& r = representatives[i];
+        bool dominated = false;
 
-        if (is_duplicate)
-            t_stats.duplicates_pruned++;
-        else
-            useful_guesses.set(candidates[i].guess_index);
+        for (size_t j = 0; j < std::min(num_kept, width) && !dominated; ++j) {
+            t_stats.dominance_checks++;
+            dominated = refines(representatives[j].guess_index, r.guess_index);
+        }
+
+        if (dominated) t_stats.dominated_pruned++;
+        else representatives[num_kept++] = r;
     }
+    representatives.resize(num_kept);
+}
 
-    t_stats.total_actions_kept += useful_guesses.count();
+DominancePolicy parse_dominance_policy(const std::string& name) {
+    if (name == "off") return DominancePolicy::Off;
+    if (name == "approx") return DominancePolicy::Approximate;
+    if (name == "exact") return DominancePolicy::Exact;
+    throw std::runtime_error("Unknown dominance policy " + name + " (expected off, approx or exact)");
+}
 
-    return useful_guesses;
+GuessOrder parse_guess_order(const std::string& name) {
+    if (name == "index") return GuessOrder::Index;
+    if (name == "buckets") return GuessOrder::BucketCount;
+    if (name == "largest") return GuessOrder::LargestBucket;
+    if (name == "entropy") return GuessOrder::Entropy;
+    throw std::runtime_error("Unknown guess order " + name + " (expected index, buckets, largest or entropy)");
 }
+
+#define INSTANTIATE(W) template class Solver<W>;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -3,38 +3,58 @@
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #include <array>
-#include <immintrin.h>
 
-Wordle::Wordle(const Config& c) : config(c) {
-    std::fstream answer_file(ANSWERS_PATH, std::ios::in);
-    std::fstream guess_file(GUESSES_PATH, std::ios::in);
+Wordle::Wordle(const Config& c) : config(c), kernels(&get_kernels(c.kernel_path)) {
+    std::fstream answer_file(config.answers_path, std::ios::in);
+    std::fstream guess_file(config.guesses_path, std::ios::in);
 
-    answers.reserve(NUM_ANSWERS);
-    guesses.reserve(NUM_GUESSES);
+    if (!answer_file.is_open())
+        throw std::runtime_error("Couldn't open answers file " + config.answers_path);
+
+    if (!guess_file.is_open())
+        throw std::runtime_error("Couldn't open guesses file " + config.guesses_path);
 
     std::string line;
-    while (std::getline(answer_file, line)) { answers.push_back(line); }
-    while (std::getline(guess_file, line)) { guesses.push_back(line); }
+    while (std::getline(answer_file, line)) { if (!line.empty()) answers.push_back(line); }
+    while (std::getline(guess_file, line)) { if (!line.empty()) guesses.push_back(line); }
+
+    if (answers.empty() || answers.size() > MAX_STATE_WIDTH)
+        throw std::runtime_error("Answers size out of range: expected 1 to " + std::to_string(MAX_STATE_WIDTH) + ", got " + std::to_string(answers.size()));
 
-    if (answers.size() != NUM_ANSWERS)
-        throw std::runtime_error("Answers size mismatch: expected " + std::to_string(NUM_ANSWERS) + ", got " + std::to_string(answers.size()));
+    if (guesses.empty() || guesses.size() > MAX_GUESSES)
+        throw std::runtime_error("Guesses size out of range: expected 1 to " + std::to_string(MAX_GUESSES) + ", got " + std::to_string(guesses.size()));
 
-    if (guesses.size() != NUM_GUESSES)
-        throw std::runtime_error("Guesses size mismatch: expected " + std::to_string(NUM_GUESSES) + ", got " + std::to_string(guesses.size()));
+    row_stride = (num_answers() + 63) / 64 * 64;
 
-    pattern_lut.resize(NUM_GUESSES * NUM_ANSWERS + 64); // Inits all to 0
+    // The SIMD kernels read whole words of the engine's width, which can run past the last row
+    pattern_lut.resize(static_cast<size_t>(num_guesses()) * row_stride + MAX_STATE_WIDTH); // Inits all to 0
 }
 
 void Wordle::build_lut() {
+    int num_g = num_guesses();
+    int num_a = num_answers();
+
     #pragma omp parallel for collapse(2)
-    for (int g = 0; g < NUM_GUESSES; ++g) {
-        for (int a = 0; a < NUM_ANSWERS; ++a) {
-            pattern_lut[g * NUM_ANSWERS + a] = compute_pattern(guesses[g], answers[a]); // Shouldn't get out of bounds
+    for (int g = 0; g < num_g; ++g) {
+        for (int a = 0; a < num_a; ++a) {
+            pattern_lut[g * row_stride + a] = compute_pattern(guesses[g], answers[a]); // Shouldn't get out of bounds
         }
     }
 }
 
+uint64_t Wordle::word_list_hash() const {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a, same as the bitset hash
+    auto mix = [&](const std::string& word) {
+        for (char c : word) hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        hash = (hash ^ '\n') * 1099511628211ULL;
+    };
+    for (const auto& word : answers) mix(word);
+    for (const auto& word : guesses) mix(word);
+    return hash;
+}
+
 Pattern Wordle::compute_pattern(const std::string& guess, const std::string& target) {
     std::array<Color, 5> colors = {Color::Gray, Color::Gray, Color::Gray, Color::Gray, Color::Gray};
     std::array<uint8_t, 26> target_freq = {0};
@@ -69,36 +89,56 @@ Pattern Wordle::compute_pattern(const std::string& guess, const std::string& tar
     return pattern;
 }
 
-const StateBitset Wordle::prune_state(const StateBitset& current, int guess_index, Pattern target_pattern) const {
-    StateBitset next_state;
-
-    __m256i targets = _mm256_set1_epi8(static_cast<char>(target_pattern));
-
-    const uint8_t* row = &pattern_lut[guess_index * NUM_ANSWERS];
-
-    // Since I can hold 256 bits, thats 32 * 8
-    for (int w = 0; w < current.NUM_WORDS; ++w) {
-        const uint8_t* low_ptr = row + (w * 64);
-
-        __m256i low_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(low_ptr));
-        __m256i low_res = _mm256_cmpeq_epi8(low_vec, targets);
+template <int N>
+const StateBitset<N> Wordle::prune_state(const StateBitset<N>& current, int guess_index, Pattern target_pattern) const {
+    StateBitset<N> next_state;
+    int first = current.first_word(), last = current.last_word();
+    if (first > last) return next_state;
 
-        uint32_t low_mask = static_cast<uint32_t>(_mm256_movemask_epi8(low_res));
-
-        // Do upper half
-        const uint8_t* hi_ptr = low_ptr + 32;
-
-        __m256i hi_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi_ptr));
-        __m256i hi_res = _mm256_cmpeq_epi8(hi_vec, targets);
-
-        uint32_t hi_mask = static_cast<uint32_t>(_mm256_movemask_epi8(hi_res));
+    // Everything outside the state's words stays zero
+    kernels->match_pattern(&pattern_lut[guess_index * row_stride + first * 64], target_pattern, current.words + first,
+                           next_state.words + first, last - first + 1);
+    return next_state;
+}
 
-        // Combine and put into new_state
-        uint64_t combined_mask = static_cast<uint64_t>(low_mask) | (static_cast<uint64_t>(hi_mask) << 32);
+template <int N>
+void Wordle::count_patterns(const StateBitset<N>& current, int guess_index, std::array<int, NUM_PATTERNS>& counts) const {
+    counts.fill(0);
+    int first = current.first_word(), last = current.last_word();
+    if (first > last) return;
+    kernels->count_patterns(&pattern_lut[guess_index * row_stride + first * 64], current.words + first, last - first + 1,
+                            counts.data());
+}
 
-        next_state.words[w] = current.words[w] & combined_mask;
+template <int N>
+void Wordle::partition_state(const StateBitset<N>& current, int guess_index, Partition<N>& out) const {
+    // Clear out whatever the last call left, instead of all 243 buckets, and only in the words it could have set
+    for (int i = 0; i < out.num_patterns; ++i) {
+        StateBitset<N>& bucket = out.buckets[out.patterns[i]];
+        for (int w = out.first_word; w <= out.last_word; ++w) bucket.words[w] = 0;
+        out.counts[out.patterns[i]] = 0;
+    }
+    out.num_patterns = 0;
+    out.first_word = current.first_word();
+    out.last_word = current.last_word();
+
+    const uint8_t* row = &pattern_lut[guess_index * row_stride];
+
+    // Scatter each answer straight into its bucket
+    for (int answer_index : current) {
+        Pattern p = row[answer_index];
+        if (out.counts[p]++ == 0)
+            out.patterns[out.num_patterns++] = p;
+        out.buckets[p].set(answer_index);
     }
 
-    return next_state;
+    // Callers walk the buckets in pattern order, same as looping over all 243
+    std::sort(out.patterns.begin(), out.patterns.begin() + out.num_patterns);
 }
 
+#define INSTANTIATE(W) \
+    template const StateBitset<W> Wordle::prune_state<W>(const StateBitset<W>&, int, Pattern) const; \
+    template void Wordle::count_patterns<W>(const StateBitset<W>&, int, std::array<int, NUM_PATTERNS>&) const; \
+    template void Wordle::partition_state<W>(const StateBitset<W>&, int, Partition<W>&) const;
+WORDLE_STATE_WIDTHS(INSTANTIATE)
+#undef INSTANTIATE
@@ -1,99 +1,341 @@
+#include "Checkpoint.hpp"
 #include "MemoizationTable.hpp"
+#include "MemoStore.hpp"
+#include "LowerBound.hpp"
+#include "Profile.hpp"
+#include "Progress.hpp"
 #include "Solver.hpp"
 #include "Wordle.hpp"
+#include "Kernels.hpp"
 #include "Statistics.hpp"
 #include "Definitions.hpp"
+#ifdef WORDLE_MPI
+#include "Distributed.hpp"
+#endif
 
-// #include <chrono>
+#include <omp.h>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <algorithm>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 SolverStats g_stats;
 
-struct RunState {
-    int next_guess_index = 0;
-    double global_min = 1000; // Just start high
-    int best_index = -1; // None yet
-};
+// For the on|off switches. Throws on anything else
+bool parse_switch(const std::string& arg, const std::string& value) {
+    if (value == "on") return true;
+    if (value == "off") return false;
+    throw std::runtime_error(arg + " takes on or off, not " + value);
+}
 
 const Config parse_args(int argc, char** argv) {
-    return {};
+    Config config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--answers") config.answers_path = value();
+        else if (arg == "--guesses") config.guesses_path = value();
+        else if (arg == "--openers") config.openers_path = value();
+        else if (arg == "--kernels") config.kernel_path = parse_kernel_path(value());
+        else if (arg == "--task-depth") config.task_depth = std::stoi(value());
+        else if (arg == "--task-min-size") config.task_min_size = std::stoi(value());
+        else if (arg == "--checkpoint") { config.enable_checkpointing = true; config.checkpoint_path = value(); }
+        else if (arg == "--checkpoint-interval") config.checkpoint_interval = std::stoi(value());
+        else if (arg == "--memo-store") config.memo_store_path = value();
+        else if (arg == "--memo-backend") config.memo_backend = parse_memo_backend(value());
+        else if (arg == "--memo-verify") config.memo_verify = true;
+        else if (arg == "--lockfree-slots-log2") config.lockfree_slots_log2 = std::stoi(value());
+        else if (arg == "--claims") config.claim_policy = parse_claim_policy(value());
+        else if (arg == "--claim-min-size") config.claim_min_size = std::stoi(value());
+        else if (arg == "--top-k") config.top_k = std::stoi(value());
+        else if (arg == "--exchange-interval") config.exchange_interval = std::stoi(value());
+        else if (arg == "--share-min-size") config.share_min_size = std::stoi(value());
+        else if (arg == "--share-max-depth") config.share_max_depth = std::stoi(value());
+        else if (arg == "--small-state-max") config.small_state_max = std::stoi(value());
+        else if (arg == "--dominance") config.dominance = parse_dominance_policy(value());
+        else if (arg == "--dominance-width") config.dominance_width = std::stoi(value());
+        else if (arg == "--guess-order") config.guess_order = parse_guess_order(value());
+        else if (arg == "--order-top-k") config.order_top_k = std::stoi(value());
+        else if (arg == "--progress-freq") config.stats_print_freq = std::stoi(value());
+        else if (arg == "--progress-json") config.progress_json_path = value();
+        else if (arg == "--memo-budget-mb") config.memo_budget_mb = std::stoi(value());
+        else if (arg == "--bound-budget-mb") config.bound_budget_mb = std::stoi(value());
+        else if (arg == "--cutoffs") config.enable_cutoffs = parse_switch(arg, value());
+        else if (arg == "--partition-bounds") config.partition_bounds = parse_switch(arg, value());
+        else if (arg == "--deep-cutoffs") config.deep_cutoffs = parse_switch(arg, value());
+        else throw std::runtime_error("Unknown argument " + arg);
+    }
+
+    return config;
 }
 
-int main(int argc, char** argv) {
-    const Config config = parse_args(argc, argv);
-    std::cout << "Parsed Config\n";
+// The guess indices of the words in path, for --openers. Throws on a word that isn't a guess
+std::vector<bool> read_openers(const std::string& path, const Wordle& game) {
+    std::ifstream file(path);
+    if (!file.is_open()) throw std::runtime_error("Couldn't open openers file " + path);
 
-    Wordle game(config);
+    std::unordered_map<std::string, int> guess_index;
+    for (int g = 0; g < game.num_guesses(); ++g) guess_index[game.get_guess_str(g)] = g;
 
-    game.build_lut();
-    std::cout << "Build LUT\n";
+    std::vector<bool> is_opener(game.num_guesses(), false);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        auto it = guess_index.find(line);
+        if (it == guess_index.end()) throw std::runtime_error("Opener " + line + " isn't in the guesses");
+        is_opener[it->second] = true;
+    }
+    if (std::none_of(is_opener.begin(), is_opener.end(), [](bool b) { return b; }))
+        throw std::runtime_error("No openers in " + path);
+    return is_opener;
+}
 
-    std::vector<int> task_order(NUM_GUESSES);
+// Everything after loading the words, compiled for each state width
+template <int N>
+int run(const Config& config, const Wordle& game) {
+    std::vector<int> task_order(game.num_guesses());
     std::iota(task_order.begin(), task_order.end(), 0);
     std::mt19937 rng(67); // hehe
     std::shuffle(task_order.begin(), task_order.end(), rng);
     std::cout << "Shuffled Task Order\n";
 
-    MemoizationTable cache(config);
-    Solver solver(config, game, cache);
+    // Filtered after the shuffle, so a subset is searched in the same relative order as in a full run
+    if (!config.openers_path.empty()) {
+        std::vector<bool> is_opener = read_openers(config.openers_path, game);
+        task_order.erase(std::remove_if(task_order.begin(), task_order.end(), [&](int g) { return !is_opener[g]; }), task_order.end());
+        std::cout << "Only trying " << task_order.size() << " openers from " << config.openers_path << "\n";
+    }
+
+    MemoizationTable<N> cache(config);
+    LowerBound<N> bounds(config, game);
+    Solver<N> solver(config, game, cache, bounds);
     g_stats = SolverStats();
 
+    std::unique_ptr<MemoStore<N>> store;
+    if (!config.memo_store_path.empty()) {
+        store = std::make_unique<MemoStore<N>>(config.memo_store_path, game);
+        cache.attach_store(store.get());
+        std::cout << "Warm starting from " << config.memo_store_path << " (" << store->size() << " entries)\n";
+    }
+
+#ifdef WORDLE_MPI
+    // Tickets are handed out across ranks, so no one rank's RunState says which openers are done
+    if (config.enable_checkpointing)
+        throw std::runtime_error("WordleSolverMPI can't checkpoint yet");
+    if (config.memo_backend == MemoBackendType::Fingerprint)
+        throw std::runtime_error("WordleSolverMPI needs a memo backend that keeps whole states to share");
+#endif
+
     RunState state;
-    // TODO: Checkpoint recovery here
+    if (config.enable_checkpointing && load_checkpoint(config.checkpoint_path, game, state, cache))
+        std::cout << "Resumed from " << config.checkpoint_path << " (" << state.completed.size() << " openers done, "
+                  << cache.size() << " memo entries)\n";
+
+    // Finished openers are skipped, but the rest keep their shuffled order
+    std::vector<bool> is_done(game.num_guesses(), false);
+    for (int guess : state.completed) is_done[guess] = true;
+    task_order.erase(std::remove_if(task_order.begin(), task_order.end(), [&](int g) { return is_done[g]; }), task_order.end());
+
+    // With --top-k, the k best exact costs so far. Once there are k, the worst of them is the bar every other
+    // opener has to beat, shared with the solver so running openers get cut as soon as it drops below them
+    std::vector<double> top_costs;
+    std::atomic<double> root_budget {NO_BUDGET};
+    auto record_top = [&](double cost) {
+        if (config.top_k <= 0) return;
+        top_costs.insert(std::upper_bound(top_costs.begin(), top_costs.end(), cost), cost);
+        if (static_cast<int>(top_costs.size()) > config.top_k) top_costs.pop_back();
+        if (static_cast<int>(top_costs.size()) == config.top_k && top_costs.back() < root_budget.load())
+            root_budget.store(top_costs.back()); // Other ranks can have lowered it further
+    };
+    for (size_t i = 0; i < state.completed.size(); ++i)
+        if (!state.cut[i]) record_top(state.costs[i]);
+    if (config.top_k > 0) solver.share_root_budget(&root_budget);
 
-    std::atomic<int> ticket_counter {state.next_guess_index};
+    std::atomic<int> ticket_counter {0};
+    int num_tickets = static_cast<int>(task_order.size());
 
-    // auto last_checkpoint_ts = std::chrono::steady_clock::now(); // TODO: Checkpointing
+#ifdef WORDLE_MPI
+    Distributed<N> dist(config, cache, root_budget);
+    std::string rank_tag = "[rank " + std::to_string(dist.rank()) + "] ";
+#else
+    std::string rank_tag;
+#endif
+
+    // Tickets are shared between ranks, so one rank can't tell how close the run is to done
+#ifdef WORDLE_MPI
+    ProgressReporter progress(config, 0, [&]() { return cache.memory_bytes(); }, [&]() { return bounds.memory_bytes(); },
+                              dist.rank());
+#else
+    ProgressReporter progress(config, num_tickets, [&]() { return cache.memory_bytes(); }, [&]() { return bounds.memory_bytes(); });
+#endif
+    progress.start();
+
+    auto last_checkpoint_ts = std::chrono::steady_clock::now();
     std::mutex save_mutex;
 
+    auto checkpoint = [&]() {
+        RunState snapshot;
+        #pragma omp critical
+        snapshot = state;
+
+        auto start = std::chrono::steady_clock::now();
+        save_checkpoint(config.checkpoint_path, game, snapshot, cache);
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+
+        #pragma omp critical
+        std::cout << "Checkpoint saved (" << snapshot.completed.size() << " openers, " << cache.size() << " memo entries, "
+                  << took.count() << "s)\n";
+    };
+
     // These set both to all being possible
-    StateBitset root_state = StateBitset();
-    root_state.set();
+    StateBitset<N> root_state = StateBitset<N>();
+    root_state.set_first(game.num_answers());
     GuessBitset root_guesses = GuessBitset();
-    root_guesses.set();
+    root_guesses.set_first(game.num_guesses());
 
     std::cout << "Starting Simulation\n\n";
 
     #pragma omp parallel
     {
         t_stats = SolverStats(); // Every thread gets it's own
+        progress.attach(omp_get_thread_num());
 
         while (true) {
+#ifdef WORDLE_MPI
+            int ticket = dist.next_ticket();
+#else
             int ticket = ticket_counter.fetch_add(1);
-            if (ticket >= NUM_GUESSES) break;
+#endif
+            if (ticket >= num_tickets) break;
 
             int guess_ind = task_order[ticket];
 
-            SearchResult res = solver.evaluate_guess(root_state, guess_ind, root_guesses, 1);
+            SearchResult res = solver.evaluate_guess(root_state, guess_ind, root_guesses, 1, root_budget.load());
 
             #pragma omp critical
             {
                 g_stats += t_stats;
-                std::cout << "Solved " << game.get_guess_str(guess_ind) << " to " << res.expected_cost;
-                if (res.expected_cost < state.global_min) {
+                fold_progress();
+                t_stats = SolverStats(); // Already counted
+                profile_collect();
+                progress.ticket_done();
+                std::cout << rank_tag;
+                if (res.is_cut) {
+                    std::cout << "Cut " << game.get_guess_str(guess_ind) << " at " << res.expected_cost;
+                } else {
+                    std::cout << "Solved " << game.get_guess_str(guess_ind) << " to " << res.expected_cost;
+                    record_top(res.expected_cost);
+                }
+                if (!res.is_cut && res.expected_cost < state.global_min) {
                     state.global_min = res.expected_cost;
                     state.best_index = guess_ind;
                     std::cout << "\t[NEW BEST]";
                 }
+                std::cout << "\t(memo " << cache.memory_bytes() / (1024 * 1024) << " MB, bounds " << bounds.memory_bytes() / (1024 * 1024)
+                          << " MB, rss " << current_rss_bytes() / (1024 * 1024) << " MB)";
                 std::cout << '\n';
+                state.completed.push_back(guess_ind);
+                state.costs.push_back(res.expected_cost);
+                state.cut.push_back(res.is_cut);
+            }
+
+#ifdef WORDLE_MPI
+            dist.maybe_exchange();
+#endif
 
-                // if (ticket_counter % config.stats_print_freq == 0)
-                //     g_stats.print();
+            // Only one thread saves, and the others don't wait for it. The memo dump only locks one submap at a time
+            if (config.enable_checkpointing) {
+                std::unique_lock<std::mutex> lock(save_mutex, std::try_to_lock);
+                if (lock && std::chrono::steady_clock::now() - last_checkpoint_ts >= std::chrono::seconds(config.checkpoint_interval)) {
+                    checkpoint();
+                    last_checkpoint_ts = std::chrono::steady_clock::now();
+                }
             }
+        }
+
+        // Out of openers, so help with whatever tasks the others split off. The barrier only passes once they're all done
+        #pragma omp barrier
 
-            // TODO: Checkpoint logic
-            // Check the clock, grab mutex, then call MemoizationTable.dump or something
-            // MemoizationTable should have a shared mutex that effectively pauses all workers during a checkpoint
+        #pragma omp critical
+        {
+            g_stats += t_stats;
+            profile_collect();
+            fold_progress();
         }
+        ProgressReporter::detach();
     }
+    progress.stop();
+
+#ifdef WORDLE_MPI
+    // Everything from here on is rank 0's, with every rank's openers and stats
+    dist.finish();
+    state = dist.gather(state, g_stats);
+    if (dist.rank() != 0) return 0;
+
+    top_costs.clear();
+    for (size_t i = 0; i < state.completed.size(); ++i)
+        if (!state.cut[i]) record_top(state.costs[i]);
+#endif
+
+    if (config.enable_checkpointing) checkpoint(); // Final one, so a rerun just prints the answer
 
     std::cout << "\n\nComputation Complete! Best opener is " << game.get_guess_str(state.best_index)
               << " at " << state.global_min << " expected guesses\n";
 
+    if (config.top_k > 0) {
+        std::vector<int> order(state.completed.size());
+        std::iota(order.begin(), order.end(), 0);
+        order.erase(std::remove_if(order.begin(), order.end(), [&](int i) { return state.cut[i]; }), order.end());
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return state.costs[a] < state.costs[b]; });
+
+        // Ties with the k-th are never cut, so there can be a few more than k
+        std::cout << "Top " << config.top_k << " openers:\n";
+        for (int i : order)
+            if (!top_costs.empty() && state.costs[i] <= top_costs.back())
+                std::cout << "  " << game.get_guess_str(state.completed[i]) << "\t" << state.costs[i] << "\n";
+    }
+
     g_stats.print();
+    profile_report(); // Only with WORDLE_PROFILE. Under MPI, rank 0's threads only
 
     return 0;
 }
+
+int main(int argc, char** argv) {
+#ifdef WORDLE_MPI
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+    if (provided < MPI_THREAD_SERIALIZED) {
+        std::cerr << "MPI can't be called from more than one thread\n";
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    struct Finalize { ~Finalize() { MPI_Finalize(); } } finalize;
+#endif
+
+    const Config config = parse_args(argc, argv);
+    std::cout << "Parsed Config\n";
+
+    Wordle game(config);
+
+    game.build_lut();
+    std::cout << "Build LUT (" << game.num_answers() << " answers, " << game.num_guesses() << " guesses)\n";
+    std::cout << "Using " << game.active_kernels().name << " kernels\n";
+
+    // Smallest compiled state width that holds every answer
+    #define DISPATCH(W) if (game.num_answers() <= W) return run<W>(config, game);
+    WORDLE_STATE_WIDTHS(DISPATCH)
+    #undef DISPATCH
+
+    return 1; // Unreachable, Wordle rejects anything over MAX_STATE_WIDTH
+}
@@ -0,0 +1,72 @@
+// Merges the memo tables of finished runs (their checkpoints) into a MemoStore for later runs to warm start from
+// Usage: WordleMemoMerge --store <path> [--answers <path>] [--guesses <path>] <checkpoint>...
+
+#include "Checkpoint.hpp"
+#include "MemoizationTable.hpp"
+#include "MemoStore.hpp"
+#include "Wordle.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+template <int N>
+int merge(const Config& config, const Wordle& game, const std::string& store_path, const std::vector<std::string>& checkpoints) {
+    MemoizationTable<N> merged(config);
+
+    // Whatever is already in the store stays in it
+    if (std::ifstream(store_path).good()) {
+        MemoStore<N> existing(store_path, game);
+        existing.for_each([&](const StateBitset<N>& state, int depth, const SearchResult& res) {
+            merged.insert(state, depth, res);
+        });
+        std::cout << "Read " << existing.size() << " entries from " << store_path << '\n';
+    }
+
+    for (const auto& path : checkpoints) {
+        size_t before = merged.size();
+        RunState ignored;
+        if (!load_checkpoint(path, game, ignored, merged))
+            throw std::runtime_error("Couldn't open checkpoint " + path);
+        std::cout << "Merged " << path << " (" << merged.size() - before << " new entries)\n";
+    }
+
+    MemoStore<N>::write(store_path, game, merged);
+    std::cout << "Wrote " << merged.size() << " entries to " << store_path << '\n';
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    std::string store_path;
+    std::vector<std::string> checkpoints;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--store") store_path = value();
+        else if (arg == "--answers") config.answers_path = value();
+        else if (arg == "--guesses") config.guesses_path = value();
+        else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown argument " + arg);
+        else checkpoints.push_back(arg);
+    }
+
+    if (store_path.empty() || checkpoints.empty()) {
+        std::cerr << "Usage: WordleMemoMerge --store <path> [--answers <path>] [--guesses <path>] <checkpoint>...\n";
+        return 1;
+    }
+
+    Wordle game(config); // Only the word lists are needed, not the LUT
+
+    #define DISPATCH(W) if (game.num_answers() <= W) return merge<W>(config, game, store_path, checkpoints);
+    WORDLE_STATE_WIDTHS(DISPATCH)
+    #undef DISPATCH
+
+    return 1;
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "Checkpoint.hpp"
+
+class CheckpointTest : public ::testing::Test {
+protected:
+    static Config config;
+    static std::unique_ptr<Wordle> game;
+
+    std::string path;
+
+    static void SetUpTestSuite() {
+        config.guesses_path = "data/answers_small.txt"; // No LUT needed, just the word lists
+        game = std::make_unique<Wordle>(config);
+    }
+
+    void SetUp() override {
+        path = ::testing::TempDir() + "checkpoint_test.ckpt";
+        std::remove(path.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+Config CheckpointTest::config;
+std::unique_ptr<Wordle> CheckpointTest::game;
+
+// 1. RunState and the memo both come back, and no temp file is left behind
+TEST_F(CheckpointTest, RoundTrip) {
+    StateBitset<64> state;
+    state.set(3);
+    state.set(9);
+
+    MemoizationTable<64> cache(config);
+    cache.insert(state, 2, SearchResult{2.0, 4, 2});
+
+    RunState run;
+    run.completed = {5, 1, 12};
+    run.costs = {3.9, 3.42, 4.1};
+    run.cut = {0, 0, 1};
+    run.global_min = 3.42;
+    run.best_index = 1;
+
+    save_checkpoint(path, *game, run, cache);
+    EXPECT_FALSE(std::ifstream(path + ".tmp").good());
+
+    RunState loaded_run;
+    MemoizationTable<64> loaded_cache(config);
+    ASSERT_TRUE(load_checkpoint(path, *game, loaded_run, loaded_cache));
+
+    EXPECT_EQ(loaded_run.completed, run.completed);
+    EXPECT_EQ(loaded_run.costs, run.costs);
+    EXPECT_EQ(loaded_run.cut, run.cut);
+    EXPECT_DOUBLE_EQ(loaded_run.global_min, 3.42);
+    EXPECT_EQ(loaded_run.best_index, 1);
+
+    auto entry = loaded_cache.get(state, 2);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_DOUBLE_EQ(entry->expected_cost, 2.0);
+}
+
+// 2. Nothing there is a clean start, not an error
+TEST_F(CheckpointTest, MissingFileIsFreshStart) {
+    RunState run;
+    MemoizationTable<64> cache(config);
+    EXPECT_FALSE(load_checkpoint(path, *game, run, cache));
+    EXPECT_TRUE(run.completed.empty());
+}
+
+// 3. A checkpoint from other word lists would have meaningless indices, so it's refused
+TEST_F(CheckpointTest, RejectsDifferentWordLists) {
+    RunState run;
+    MemoizationTable<64> cache(config);
+    save_checkpoint(path, *game, run, cache);
+
+    Config other = config;
+    other.guesses_path = "data/guesses.txt";
+    Wordle other_game(other);
+
+    MemoizationTable<64> other_cache(other);
+    EXPECT_THROW(load_checkpoint(path, other_game, run, other_cache), std::runtime_error);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <random>
+#include <vector>
+#include "Kernels.hpp"
+
+// Every kernel path is checked against plain loops over the same random row, so they all agree with each other
+class KernelsTest : public ::testing::TestWithParam<KernelPath> {
+protected:
+    static constexpr int NUM_WORDS = 37; // Same as a 2368 bit state
+
+    std::vector<uint8_t> row;
+
+    void SetUp() override {
+        if (!kernel_supported(GetParam()))
+            GTEST_SKIP() << "This CPU can't run " << static_cast<int>(GetParam());
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pattern(0, NUM_PATTERNS - 1);
+        row.resize(NUM_WORDS * 64);
+        for (auto& p : row) p = static_cast<uint8_t>(pattern(rng));
+
+        // Plenty of the real patterns are all gray or all green, so make sure the edges show up a lot
+        for (int i = 0; i < NUM_WORDS * 64; i += 5) row[i] = (i % 2) ? 0 : NUM_PATTERNS - 1;
+    }
+
+    // Mix of empty, sparse, dense and full words
+    std::vector<uint64_t> make_state(int seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> state(NUM_WORDS);
+        for (int w = 0; w < NUM_WORDS; ++w) {
+            switch (w % 4) {
+                case 0: state[w] = 0; break;
+                case 1: state[w] = rng() & rng() & rng(); break;
+                case 2: state[w] = rng() | rng(); break;
+                case 3: state[w] = ~0ULL; break;
+            }
+        }
+        return state;
+    }
+};
+
+// 1. Matching a pattern keeps exactly the active answers with that byte
+TEST_P(KernelsTest, MatchPatternMatchesReference) {
+    const Kernels& kernels = get_kernels(GetParam());
+    EXPECT_EQ(kernels.path, GetParam());
+
+    for (int seed : {1, 2, 3}) {
+        auto state = make_state(seed);
+
+        for (int target = 0; target < NUM_PATTERNS; ++target) {
+            std::vector<uint64_t> out(NUM_WORDS, 0xDEADBEEF);
+            kernels.match_pattern(row.data(), static_cast<uint8_t>(target), state.data(), out.data(), NUM_WORDS);
+
+            for (int w = 0; w < NUM_WORDS; ++w) {
+                uint64_t expected = 0;
+                for (int b = 0; b < 64; ++b)
+                    if (row[w * 64 + b] == target) expected |= 1ULL << b;
+                expected &= state[w];
+
+                ASSERT_EQ(out[w], expected) << "Word " << w << " pattern " << target << " seed " << seed;
+            }
+        }
+    }
+}
+
+// 2. The histogram counts only active answers, and adds on to what's already there
+TEST_P(KernelsTest, CountPatternsMatchesReference) {
+    const Kernels& kernels = get_kernels(GetParam());
+
+    for (int seed : {1, 2, 3}) {
+        auto state = make_state(seed);
+
+        std::array<int, NUM_PATTERNS> expected = {0};
+        for (int w = 0; w < NUM_WORDS; ++w)
+            for (int b = 0; b < 64; ++b)
+                if (state[w] & (1ULL << b)) expected[row[w * 64 + b]]++;
+
+        std::array<int, NUM_PATTERNS> counts;
+        counts.fill(1);
+        kernels.count_patterns(row.data(), state.data(), NUM_WORDS, counts.data());
+
+        for (int p = 0; p < NUM_PATTERNS; ++p)
+            ASSERT_EQ(counts[p], expected[p] + 1) << "Pattern " << p << " seed " << seed;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllPaths, KernelsTest,
+    ::testing::Values(KernelPath::Scalar, KernelPath::AVX2, KernelPath::AVX512),
+    [](const ::testing::TestParamInfo<KernelPath>& info) {
+        switch (info.param) {
+            case KernelPath::Scalar: return "Scalar";
+            case KernelPath::AVX2: return "AVX2";
+            case KernelPath::AVX512: return "AVX512";
+            default: return "Auto";
+        }
+    });
+
+// 3. Auto always lands on something this CPU can run, and names parse both ways
+TEST(KernelDispatch, AutoPicksSupportedPath) {
+    const Kernels& kernels = get_kernels(KernelPath::Auto);
+    EXPECT_NE(kernels.path, KernelPath::Auto);
+    EXPECT_TRUE(kernel_supported(kernels.path));
+    EXPECT_EQ(parse_kernel_path(kernels.name), kernels.path);
+    EXPECT_THROW(parse_kernel_path("sse9"), std::runtime_error);
+}
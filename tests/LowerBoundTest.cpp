@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "LowerBound.hpp"
+#include "MemoizationTable.hpp"
+#include "Solver.hpp"
+
+class LowerBoundTest : public ::testing::Test {
+protected:
+    // The LUT is the slow part, so share one game across the tests
+    static Config config;
+    static std::unique_ptr<Wordle> game;
+
+    std::unique_ptr<LowerBound<64>> bounds; // Small states, so the narrowest engine
+
+    static void SetUpTestSuite() {
+        config.enable_cutoffs = false; // So evaluate_guess gives exact values to check against
+        game = std::make_unique<Wordle>(config);
+        game->build_lut();
+    }
+
+    void SetUp() override {
+        bounds = std::make_unique<LowerBound<64>>(config, *game);
+    }
+
+    // Exact solve_state value, by trying every guess
+    double exact_cost(const StateBitset<64>& state, int depth) {
+        MemoizationTable<64> cache(config);
+        Solver<64> solver(config, *game, cache, *bounds);
+
+        GuessBitset all_guesses;
+        all_guesses.set_first(game->num_guesses());
+
+        double best = UNSOLVED_COST;
+        for (int g = 0; g < game->num_guesses(); ++g)
+            best = std::min(best, solver.evaluate_guess(state, g, all_guesses, depth + 1).expected_cost);
+        return best;
+    }
+};
+
+Config LowerBoundTest::config;
+std::unique_ptr<Wordle> LowerBoundTest::game;
+
+// 1. Floors follow the depth rules of solve_state
+TEST_F(LowerBoundTest, FloorsMatchDepthRules) {
+    EXPECT_DOUBLE_EQ(bounds->floor(0, 2), 0.0);
+    EXPECT_DOUBLE_EQ(bounds->floor(1, 2), 1.0);
+    EXPECT_DOUBLE_EQ(bounds->floor(7, 2), 2.0);
+
+    // Children of depth 6 are past the limit, so all it can do is fail
+    EXPECT_DOUBLE_EQ(bounds->floor(7, 6), UNSOLVED_COST);
+
+    // Past the limit even a singleton fails
+    EXPECT_DOUBLE_EQ(bounds->floor(1, 7), config.fail_cost);
+}
+
+// 2. Partition bounds never overshoot the real value
+TEST_F(LowerBoundTest, PartitionBoundIsAdmissible) {
+    GuessBitset all_guesses;
+    all_guesses.set_first(game->num_guesses());
+
+    for (int size : {2, 3, 5, 8}) {
+        StateBitset<64> state;
+        for (int i = 0; i < size; ++i) state.set(i * 3);
+
+        double bound = bounds->partition_bound(state, all_guesses, 2);
+        EXPECT_GE(bound, bounds->floor(size, 2));
+        EXPECT_LE(bound, exact_cost(state, 2) + 1e-9) << "Bound overshoots for size " << size;
+    }
+}
+
+// 3. Proven bounds keep the strongest proof and don't leak across depths
+TEST_F(LowerBoundTest, ProvenBoundsKeepStrongest) {
+    StateBitset<64> state;
+    state.set(0);
+    state.set(1);
+
+    EXPECT_FALSE(bounds->get_proven(state, 4).has_value());
+
+    bounds->insert_proven(state, 4, 2.5);
+    bounds->insert_proven(state, 4, 2.1);
+
+    auto proven = bounds->get_proven(state, 4);
+    ASSERT_TRUE(proven.has_value());
+    EXPECT_DOUBLE_EQ(*proven, 2.5);
+
+    EXPECT_FALSE(bounds->get_proven(state, 2).has_value());
+}
+
+// 4. A bound budget caps both caches, and what gets evicted comes back the same when it's worked out again
+TEST_F(LowerBoundTest, BudgetCapsCaches) {
+    Config conf = config;
+    conf.bound_budget_mb = 1;
+    LowerBound<64> bounded(conf, *game);
+
+    GuessBitset all_guesses;
+    all_guesses.set_first(game->num_guesses());
+
+    // A few times more 4 answer states than 1 MB of both caches holds
+    std::vector<StateBitset<64>> states;
+    for (int a = 0; a < 40; ++a)
+        for (int b = a + 1; b < 40; ++b)
+            for (int c = b + 1; c < 40; ++c)
+                for (int d = c + 1; d < 40; ++d) {
+                    StateBitset<64> state;
+                    state.set(a);
+                    state.set(b);
+                    state.set(c);
+                    state.set(d);
+                    states.push_back(state);
+                }
+
+    for (const auto& state : states) {
+        bounded.partition_bound(state, all_guesses, 2);
+        bounded.insert_proven(state, 4, 2.5);
+    }
+    EXPECT_LE(bounded.memory_bytes(), 1024u * 1024u + 1024u * 1024u / 10);
+
+    // Second pass, now mostly recomputing evicted entries
+    int sampled = 0, proven_kept = 0;
+    for (size_t i = 0; i < states.size(); i += 37, ++sampled) {
+        EXPECT_DOUBLE_EQ(bounded.partition_bound(states[i], all_guesses, 2), bounds->partition_bound(states[i], all_guesses, 2));
+        proven_kept += bounded.get_proven(states[i], 4).has_value();
+    }
+    EXPECT_LT(proven_kept, sampled) << "Nothing was evicted";
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "MemoizationTable.hpp"
+#include "MemoStore.hpp"
+
+class MemoStoreTest : public ::testing::Test {
+protected:
+    static Config config;
+    static std::unique_ptr<Wordle> game;
+
+    std::string path;
+    std::unique_ptr<MemoizationTable<64>> table;
+
+    StateBitset<64> state_A;
+    StateBitset<64> state_B;
+
+    static void SetUpTestSuite() {
+        config.guesses_path = "data/answers_small.txt"; // No LUT needed, just the word lists
+        game = std::make_unique<Wordle>(config);
+    }
+
+    void SetUp() override {
+        path = ::testing::TempDir() + "memo_store_test.store";
+        table = std::make_unique<MemoizationTable<64>>(config);
+
+        state_A.set(0);
+        state_B.set(1);
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+Config MemoStoreTest::config;
+std::unique_ptr<Wordle> MemoStoreTest::game;
+
+// 1. The store answers with the same depth rules as the table it came from
+TEST_F(MemoStoreTest, MatchesTableRules) {
+    table->insert(state_A, 2, SearchResult{3.5, 10, 3}); // Agnostic, reusable down to depth 3
+    table->insert(state_B, 5, SearchResult{1e9, 20, 2}); // Specific, only at depth 5
+
+    MemoStore<64>::write(path, *game, *table);
+    MemoStore<64> store(path, *game);
+    EXPECT_EQ(store.size(), 2u);
+
+    for (int depth = 0; depth <= 6; ++depth) {
+        for (const auto* state : {&state_A, &state_B}) {
+            auto expected = table->get(*state, depth);
+            auto got = store.get(*state, depth);
+            ASSERT_EQ(got.has_value(), expected.has_value()) << "Depth " << depth;
+            if (!got) continue;
+            EXPECT_DOUBLE_EQ(got->expected_cost, expected->expected_cost);
+            EXPECT_EQ(got->best_guess_index, expected->best_guess_index);
+            EXPECT_EQ(got->max_height, expected->max_height);
+        }
+    }
+}
+
+// 2. An empty table falls back to the store behind it
+TEST_F(MemoStoreTest, BacksMemoizationTable) {
+    table->insert(state_A, 1, SearchResult{2.75, 4, 2});
+    MemoStore<64>::write(path, *game, *table);
+    MemoStore<64> store(path, *game);
+
+    MemoizationTable<64> warm(config);
+    EXPECT_FALSE(warm.get(state_A, 1).has_value());
+
+    warm.attach_store(&store);
+    auto hit = warm.get(state_A, 1);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_DOUBLE_EQ(hit->expected_cost, 2.75);
+    EXPECT_FALSE(warm.get(state_B, 1).has_value());
+}
+
+// 3. Lots of states still come back exactly, so probing works
+TEST_F(MemoStoreTest, ManyEntriesRoundTrip) {
+    for (int i = 0; i < 2000; ++i) {
+        StateBitset<64> state;
+        state.words[0] = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL;
+        table->insert(state, 1 + i % 6, SearchResult{1.0 + i, i, 1 + i % 3});
+    }
+
+    MemoStore<64>::write(path, *game, *table);
+    MemoStore<64> store(path, *game);
+    EXPECT_EQ(store.size(), table->size());
+
+    size_t seen = 0;
+    store.for_each([&](const StateBitset<64>& state, int depth, const SearchResult& res) {
+        auto expected = table->get(state, depth);
+        ASSERT_TRUE(expected.has_value());
+        EXPECT_DOUBLE_EQ(res.expected_cost, expected->expected_cost);
+        seen++;
+    });
+    EXPECT_EQ(seen, table->size());
+}
+
+// 4. A store from other word lists is refused
+TEST_F(MemoStoreTest, RejectsDifferentWordLists) {
+    MemoStore<64>::write(path, *game, *table);
+
+    Config other = config;
+    other.guesses_path = "data/guesses.txt";
+    Wordle other_game(other);
+
+    EXPECT_THROW(MemoStore<64>(path, other_game), std::runtime_error);
+    EXPECT_THROW(MemoStore<128>(path, *game), std::runtime_error);
+}
@@ -1,19 +1,26 @@
 // NOTE: Largely Generated by AI
 
 #include <gtest/gtest.h>
+#include <sstream>
+#include <atomic>
+#include <omp.h>
+#include <random>
+#include <unordered_map>
+#include <vector>
 #include "MemoizationTable.hpp"
 #include "Definitions.hpp"
 
-class MemoizationTableTest : public ::testing::Test {
+// Every backend has to follow the same rules, so the whole suite runs on each
+class MemoizationTableTest : public ::testing::TestWithParam<MemoBackendType> {
 protected:
     // 2. Use a static instance for tests. 
     // This is zero-overhead and avoids manual memory management.
 
     // 3. Use unique_ptr to delay construction until AFTER config is set
-    std::unique_ptr<MemoizationTable> table;
+    std::unique_ptr<MemoizationTable<64>> table;
 
-    StateBitset state_A;
-    StateBitset state_B;
+    StateBitset<64> state_A;
+    StateBitset<64> state_B;
 
     void SetUp() override {
         // Point the global ptr to our local test config
@@ -21,7 +28,8 @@ protected:
 
         // Now safe to construct the table
         Config conf = {}; // Default config
-        table = std::make_unique<MemoizationTable>(conf);
+        conf.memo_backend = GetParam();
+        table = std::make_unique<MemoizationTable<64>>(conf);
 
         // Arbitrary distinct states
         state_A.set(0);
@@ -31,7 +39,7 @@ protected:
 
 // Basic Agnostic Storage
 // If we insert a clean value, then we should be able to get it from any from that or above
-TEST_F(MemoizationTableTest, AgnosticRetrievalMatches) {
+TEST_P(MemoizationTableTest, AgnosticRetrievalMatches) {
     // Insert at Depth 4, Height 2 (Ends at 6). This is CLEAN.
     table->insert(state_A, 4, SearchResult{3.5, 10, 2});
 
@@ -50,7 +58,7 @@ TEST_F(MemoizationTableTest, AgnosticRetrievalMatches) {
 
 // Agnostic Depth Limit
 // If we insert a clean value, but try and retrieve it from one that would go beyond 6, it should not hit
-TEST_F(MemoizationTableTest, AgnosticRetrievalRespectsBounds) {
+TEST_P(MemoizationTableTest, AgnosticRetrievalRespectsBounds) {
     // Insert at Depth 1, Height 4 (Ends at 5). CLEAN.
     table->insert(state_A, 1, SearchResult{4.0, 10, 4});
 
@@ -62,7 +70,7 @@ TEST_F(MemoizationTableTest, AgnosticRetrievalRespectsBounds) {
 
 // 3. Specific Table Storage
 // If we insert a value that hit the wall, it should go to Specific map.
-TEST_F(MemoizationTableTest, SpecificStorageConstraints) {
+TEST_P(MemoizationTableTest, SpecificStorageConstraints) {
     // Insert at Depth 5, Height 2 (Ends at 7). TAINTED/FAIL.
     table->insert(state_A, 5, SearchResult{1e9, 20, 2});
 
@@ -79,7 +87,7 @@ TEST_F(MemoizationTableTest, SpecificStorageConstraints) {
 
 // 4. The "Off-By-One" Bug Check
 // Verify that retrieving a Specific entry returns enough height to taint the parent.
-TEST_F(MemoizationTableTest, SpecificEntryPropagatesTaint) {
+TEST_P(MemoizationTableTest, SpecificEntryPropagatesTaint) {
     // Insert at Depth 6. 
     // This implies it failed at 7. Real height 1.
     // 6 + 1 = 7 (>6). This is TAINTED.
@@ -101,7 +109,7 @@ TEST_F(MemoizationTableTest, SpecificEntryPropagatesTaint) {
 // 5. Overwrite Behavior
 // If we solve a state purely (Depth 1), it should upgrade a Tainted entry?
 // Actually, with dual maps, they exist in parallel. We prefer Agnostic.
-TEST_F(MemoizationTableTest, AgnosticPreferredOverSpecific) {
+TEST_P(MemoizationTableTest, AgnosticPreferredOverSpecific) {
     // 1. Insert Tainted version (e.g. found via deep search that hit limit)
     table->insert(state_A, 5, SearchResult{1e9, 0, 2});
 
@@ -123,7 +131,7 @@ TEST_F(MemoizationTableTest, AgnosticPreferredOverSpecific) {
 
 // 6. Boundary Edge Case: The "Perfect Fit"
 // A tree that is exactly depth 6 tall (from root) or fits exactly in remaining space.
-TEST_F(MemoizationTableTest, ExactBoundaryFit) {
+TEST_P(MemoizationTableTest, ExactBoundaryFit) {
     // Current Depth 1. Tree Height 5. Total = 6. 
     // This is the limit of "Clean". Should go to Agnostic.
     table->insert(state_A, 1, SearchResult{3.5, 10, 5});
@@ -139,7 +147,7 @@ TEST_F(MemoizationTableTest, ExactBoundaryFit) {
 }
 
 // 7. Make sure that a "barely" tainted value goes into the Specific table
-TEST_F(MemoizationTableTest, TaintedValueIsNotAgnostic) {
+TEST_P(MemoizationTableTest, TaintedValueIsNotAgnostic) {
     // Scenario: We are at Depth 1. The solution takes 6 more steps.
     // Total Depth = 1 + 6 = 7. (Fail).
     // We insert this. It should go to Specific, NOT Agnostic.
@@ -157,7 +165,7 @@ TEST_F(MemoizationTableTest, TaintedValueIsNotAgnostic) {
 
 // 8. State Collision Integrity
 // Ensure two different states with similar properties don't overwrite each other.
-TEST_F(MemoizationTableTest, DistinctStatesDoNotCollide) {
+TEST_P(MemoizationTableTest, DistinctStatesDoNotCollide) {
     table->insert(state_A, 3, SearchResult{10.0, 1, 2});
     table->insert(state_B, 3, SearchResult{20.0, 2, 2});
 
@@ -172,7 +180,7 @@ TEST_F(MemoizationTableTest, DistinctStatesDoNotCollide) {
 
 // 9. Fail Value Integrity
 // Ensure the 1e9 cost doesn't get normalized or modified strangely.
-TEST_F(MemoizationTableTest, FailCostPersists) {
+TEST_P(MemoizationTableTest, FailCostPersists) {
     double huge_cost = 1e9;
     table->insert(state_A, 6, SearchResult{huge_cost, -1, 1});
 
@@ -188,7 +196,7 @@ TEST_F(MemoizationTableTest, FailCostPersists) {
 // so the value shouldn't change. But if you have heuristics, this matters.
 // For now, assume First-Write-Wins or Last-Write-Wins. 
 // PHMAP try_emplace does NOT overwrite if key exists.
-TEST_F(MemoizationTableTest, DeterministicInsertPolicy) {
+TEST_P(MemoizationTableTest, DeterministicInsertPolicy) {
     // Insert initial value
     table->insert(state_A, 2, SearchResult{4.0, 5, 2});
 
@@ -202,7 +210,7 @@ TEST_F(MemoizationTableTest, DeterministicInsertPolicy) {
 }
 
 // 11. Ensure we get the "barely" tained value
-TEST_F(MemoizationTableTest, SpecificRetrievalPropagatesOverflow) {
+TEST_P(MemoizationTableTest, SpecificRetrievalPropagatesOverflow) {
     // Scenario: Insert same tainted value at Depth 1 (Height 6).
     table->insert(state_A, 1, SearchResult{1e9, 10, 6});
 
@@ -220,3 +228,260 @@ TEST_F(MemoizationTableTest, SpecificRetrievalPropagatesOverflow) {
     EXPECT_EQ(res->max_height, expected_height) 
         << "Height should be (7-depth) to ensure parent overflows limit";
 }
+
+// 12. A dump loads back into a fresh table with both maps intact
+TEST_P(MemoizationTableTest, SaveLoadRoundTrip) {
+    table->insert(state_A, 2, SearchResult{3.25, 10, 3});  // Agnostic
+    table->insert(state_B, 5, SearchResult{1e9, 20, 2});   // Specific
+
+    std::stringstream dump;
+    table->save(dump);
+
+    Config conf = {};
+    conf.memo_backend = GetParam();
+    MemoizationTable<64> loaded(conf);
+    loaded.load(dump);
+
+    EXPECT_EQ(loaded.size(), table->size());
+
+    auto agnostic = loaded.get(state_A, 1);
+    ASSERT_TRUE(agnostic.has_value());
+    EXPECT_DOUBLE_EQ(agnostic->expected_cost, 3.25);
+    EXPECT_EQ(agnostic->best_guess_index, 10);
+    EXPECT_EQ(agnostic->max_height, 3);
+
+    auto specific = loaded.get(state_B, 5);
+    ASSERT_TRUE(specific.has_value());
+    EXPECT_DOUBLE_EQ(specific->expected_cost, 1e9);
+    EXPECT_FALSE(loaded.get(state_B, 4).has_value());
+
+    // A dump from another width doesn't load
+    std::stringstream again;
+    table->save(again);
+    MemoizationTable<128> wider(conf);
+    EXPECT_THROW(wider.load(again), std::runtime_error);
+}
+
+// 13. With a budget, memory stays near it and the big (expensive) states outlast the small ones
+TEST_P(MemoizationTableTest, BudgetEvictsCheapStatesFirst) {
+    Config conf = {};
+    conf.memo_backend = GetParam();
+    conf.memo_budget_mb = 1;
+    MemoizationTable<64> bounded(conf);
+
+    std::vector<StateBitset<64>> big;
+    for (int i = 0; i < 100; ++i) {
+        StateBitset<64> state;
+        state.set_first(64);
+        state.reset(i % 64);
+        state.reset((i / 64 + 1) % 64);
+        big.push_back(state);
+        bounded.insert(state, 1, SearchResult{4.0, i, 4});
+    }
+
+    // Half again as many small (4 answer) states as fit, after the big ones so plain FIFO would drop the big ones first
+    // Sized off what the big ones took, since every backend's entries are a different size
+    size_t entry_bytes = bounded.memory_bytes() / big.size();
+    int max_small = static_cast<int>(3 * (1024 * 1024 / entry_bytes) / 2);
+    int small = 0;
+    for (int a = 0; a < 64 && small < max_small; ++a)
+        for (int b = a + 1; b < 64 && small < max_small; ++b)
+            for (int c = b + 1; c < 64 && small < max_small; ++c)
+                for (int d = c + 1; d < 64 && small < max_small; ++d, ++small) {
+                    StateBitset<64> state;
+                    state.set(a);
+                    state.set(b);
+                    state.set(c);
+                    state.set(d);
+                    bounded.insert(state, 1, SearchResult{2.0, 0, 2});
+                }
+
+    EXPECT_LE(bounded.memory_bytes(), 1024u * 1024u + 1024u * 1024u / 10);
+
+    int kept = 0;
+    for (const auto& state : big) kept += bounded.get(state, 1).has_value();
+    EXPECT_GT(kept, 90) << "Cost weighting should keep nearly all the big states";
+}
+
+// 14. One state can hold its agnostic value and a specific value per depth side by side, each filled once
+TEST_P(MemoizationTableTest, ValuesShareAState) {
+    table->insert(state_A, 1, SearchResult{2.5, 4, 3});   // Agnostic
+    table->insert(state_A, 4, SearchResult{1e9, 5, 3});   // Specific at 4
+    table->insert(state_A, 6, SearchResult{2e9, 6, 1});   // Specific at 6
+    EXPECT_EQ(table->size(), 3u);
+
+    EXPECT_DOUBLE_EQ(table->get(state_A, 3)->expected_cost, 2.5);
+    EXPECT_DOUBLE_EQ(table->get(state_A, 4)->expected_cost, 1e9);
+    EXPECT_DOUBLE_EQ(table->get(state_A, 6)->expected_cost, 2e9);
+    EXPECT_FALSE(table->get(state_A, 5).has_value());
+
+    // Refilling a slot that's taken is a collision, and leaves the first value
+    long collisions = t_stats.memo_collisions;
+    table->insert(state_A, 4, SearchResult{3e9, 7, 3});
+    EXPECT_EQ(t_stats.memo_collisions, collisions + 1);
+    EXPECT_DOUBLE_EQ(table->get(state_A, 4)->expected_cost, 1e9);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllBackends, MemoizationTableTest,
+    ::testing::Values(MemoBackendType::Exact, MemoBackendType::Fingerprint, MemoBackendType::LockFree),
+    [](const ::testing::TestParamInfo<MemoBackendType>& info) {
+        switch (info.param) {
+            case MemoBackendType::Fingerprint: return "Fingerprint";
+            case MemoBackendType::LockFree: return "LockFree";
+            default: return "Exact";
+        }
+    });
+
+// 15. Dumps only load into backends with the same records, and names parse both ways
+TEST(MemoBackends, DumpNamesItsBackend) {
+    Config exact_conf = {};
+    Config fp_conf = {};
+    fp_conf.memo_backend = MemoBackendType::Fingerprint;
+
+    StateBitset<64> state;
+    state.set(3);
+    MemoizationTable<64> exact(exact_conf);
+    exact.insert(state, 2, SearchResult{1.0, 3, 1});
+
+    std::stringstream dump;
+    exact.save(dump);
+    MemoizationTable<64> fingerprint(fp_conf);
+    EXPECT_THROW(fingerprint.load(dump), std::runtime_error);
+
+    // No states to list, so it can't feed MemoStore::write
+    EXPECT_THROW(fingerprint.for_each([](const StateBitset<64>&, int, const SearchResult&) {}), std::runtime_error);
+
+    // Exact and lock-free share their records, so either way works
+    std::stringstream again;
+    exact.save(again);
+    Config lf_conf = {};
+    lf_conf.memo_backend = MemoBackendType::LockFree;
+    MemoizationTable<64> lockfree(lf_conf);
+    lockfree.load(again);
+    ASSERT_TRUE(lockfree.get(state, 2).has_value());
+    EXPECT_EQ(lockfree.get(state, 2)->best_guess_index, 3);
+
+    EXPECT_EQ(parse_memo_backend(memo_backend_name(MemoBackendType::Fingerprint)), MemoBackendType::Fingerprint);
+    EXPECT_EQ(parse_memo_backend(memo_backend_name(MemoBackendType::LockFree)), MemoBackendType::LockFree);
+    EXPECT_THROW(parse_memo_backend("bloom"), std::runtime_error);
+}
+
+// 16. At full width, fingerprint entries take a fraction of the memory, and verify mode sees no collisions
+TEST(MemoBackends, FingerprintIsCompactAndVerifies) {
+    Config exact_conf = {};
+    Config fp_conf = {};
+    fp_conf.memo_backend = MemoBackendType::Fingerprint;
+    fp_conf.memo_verify = true;
+
+    MemoizationTable<2368> exact(exact_conf);
+    MemoizationTable<2368> fingerprint(fp_conf);
+
+    // Pairs of answers, so plenty of states differ by only a bit or two
+    std::vector<StateBitset<2368>> states;
+    for (int a = 0; a < 2368; a += 7)
+        for (int b = a + 1; b < 2368; b += 97) {
+            StateBitset<2368> state;
+            state.set(a);
+            state.set(b);
+            states.push_back(state);
+        }
+
+    for (size_t i = 0; i < states.size(); ++i) {
+        SearchResult res{1.5, static_cast<int>(i % 1000), 2};
+        exact.insert(states[i], 1, res);
+        fingerprint.insert(states[i], 1, res);
+    }
+
+    ASSERT_EQ(fingerprint.size(), states.size());
+    EXPECT_LT(fingerprint.memory_bytes() * 8, exact.memory_bytes());
+
+    for (size_t i = 0; i < states.size(); ++i) {
+        auto res = fingerprint.get(states[i], 1);
+        ASSERT_TRUE(res.has_value());
+        EXPECT_EQ(res->best_guess_index, static_cast<int>(i % 1000));
+    }
+    EXPECT_EQ(t_stats.fingerprint_collisions, 0);
+}
+
+// 17. Lock-free stress: threads hammer overlapping keys with inserts and gets, and every hit is the right value
+TEST(MemoBackends, LockFreeStress) {
+    constexpr int NUM_STATES = 20000;
+    constexpr int OPS_PER_THREAD = 60000;
+
+    // Every third state only ever gets tainted values, so its specific slots fill in from many threads at once
+    auto state_of = [](int i) {
+        StateBitset<64> state;
+        state.words[0] = 0x9e3779b97f4a7c15ull * static_cast<uint64_t>(i + 1);
+        return state;
+    };
+    std::unordered_map<uint64_t, int> index_of;
+    for (int i = 0; i < NUM_STATES; ++i) index_of[state_of(i).words[0]] = i;
+
+    auto tainted = [](int i) { return i % 3 == 0; };
+    auto height_of = [](int i) { return 1 + i % 5; };
+    auto agnostic_cost = [](int i) { return 1.0 + i; };
+    auto specific_cost = [](int i, int depth) { return 1e9 + i * 10 + depth; };
+
+    for (int slots_log2 : {15, 12}) { // Roomy, then too small for every state so inserts get dropped
+        Config conf = {};
+        conf.memo_backend = MemoBackendType::LockFree;
+        conf.lockfree_slots_log2 = slots_log2;
+        MemoizationTable<64> table(conf);
+
+        std::atomic<long> wrong {0};
+        std::atomic<long> hits {0};
+        SolverStats stats;
+
+        #pragma omp parallel num_threads(8)
+        {
+            t_stats = SolverStats();
+            std::mt19937 rng(1234 + omp_get_thread_num());
+            std::uniform_int_distribution<int> pick(0, NUM_STATES - 1);
+            std::uniform_int_distribution<int> pick_depth(1, 6);
+
+            for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                int i = pick(rng);
+                int depth = pick_depth(rng);
+                StateBitset<64> state = state_of(i);
+
+                if (op % 2 == 0) {
+                    if (tainted(i)) table.insert(state, depth, SearchResult{specific_cost(i, depth), i % 1000, 7 - depth});
+                    else table.insert(state, 0, SearchResult{agnostic_cost(i), i % 1000, height_of(i)});
+                    continue;
+                }
+
+                auto res = table.get(state, depth);
+                if (!res) continue;
+                hits++;
+
+                double expected = tainted(i) ? specific_cost(i, depth) : agnostic_cost(i);
+                if (res->expected_cost != expected || res->best_guess_index != i % 1000) wrong++;
+            }
+
+            #pragma omp critical
+            stats += t_stats;
+        }
+
+        EXPECT_EQ(wrong.load(), 0) << "slots 2^" << slots_log2;
+        EXPECT_GT(hits.load(), 0);
+
+        // Every value the table took is still there, intact
+        size_t seen = 0;
+        table.for_each([&](const StateBitset<64>& state, int depth, const SearchResult& res) {
+            auto it = index_of.find(state.words[0]);
+            ASSERT_NE(it, index_of.end());
+            int i = it->second;
+            seen++;
+
+            EXPECT_EQ(res.best_guess_index, i % 1000);
+            EXPECT_EQ(res.expected_cost, depth == 0 ? agnostic_cost(i) : specific_cost(i, depth));
+        });
+        EXPECT_EQ(seen, table.size());
+
+        // Each insert was stored, already there, or dropped for room, and only the second counts as duplicated work
+        EXPECT_EQ(stats.memo_inserts, static_cast<long>(seen) + stats.memo_collisions + stats.memo_evictions)
+            << "slots 2^" << slots_log2;
+        if (slots_log2 == 12) EXPECT_GT(stats.memo_evictions, 0);
+        else EXPECT_EQ(stats.memo_evictions, 0);
+    }
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <omp.h>
+#include "LowerBound.hpp"
+#include "MemoizationTable.hpp"
+#include "Solver.hpp"
+#include "Statistics.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+class SolverTest : public ::testing::Test {
+protected:
+    static Config config;
+    static std::unique_ptr<Wordle> game;
+
+    static void SetUpTestSuite() {
+        config.guesses_path = "data/answers_small.txt"; // Answers only, so full searches stay quick
+        game = std::make_unique<Wordle>(config);
+        game->build_lut();
+    }
+
+    // Fresh tables every time, so nothing carries over between the runs being compared
+    SearchResult solve_opener(const Config& c, int guess, bool parallel) {
+        MemoizationTable<64> cache(c);
+        LowerBound<64> bounds(c, *game);
+        Solver<64> solver(c, *game, cache, bounds);
+
+        StateBitset<64> root;
+        root.set_first(game->num_answers());
+        GuessBitset guesses;
+        guesses.set_first(game->num_guesses());
+
+        if (!parallel) return solver.evaluate_guess(root, guess, guesses, 1);
+
+        SearchResult res;
+        #pragma omp parallel num_threads(4)
+        #pragma omp single
+        res = solver.evaluate_guess(root, guess, guesses, 1);
+        return res;
+    }
+};
+
+Config SolverTest::config;
+std::unique_ptr<Wordle> SolverTest::game;
+
+// 1. Splitting buckets into tasks joins back to exactly what the serial loop finds
+TEST_F(SolverTest, TasksMatchSerial) {
+    for (bool cutoffs : {false, true}) {
+        for (bool deep : {false, true}) {
+            Config c = config;
+            c.enable_cutoffs = cutoffs;
+            c.deep_cutoffs = deep;
+            c.task_depth = 3;
+            c.task_min_size = 2;
+
+            for (int guess : {0, 7, 31}) {
+                SearchResult serial = solve_opener(c, guess, false);
+                SearchResult tasks = solve_opener(c, guess, true);
+
+                EXPECT_DOUBLE_EQ(tasks.expected_cost, serial.expected_cost)
+                    << "Guess " << game->get_guess_str(guess) << " cutoffs " << cutoffs << " deep " << deep;
+                EXPECT_EQ(tasks.max_height, serial.max_height);
+                EXPECT_FALSE(tasks.is_cut); // No budget at the root
+            }
+        }
+    }
+}
+
+// 2. Threads sharing a memo wait on, defer, or help with each other's claims, and still land on the same costs
+TEST_F(SolverTest, ClaimPoliciesMatchOff) {
+    const std::vector<int> openers = {0, 1, 2, 3, 7, 31};
+
+    Config off = config;
+    off.claim_policy = ClaimPolicy::Off;
+    std::vector<SearchResult> expected;
+    for (int guess : openers) expected.push_back(solve_opener(off, guess, false));
+
+    for (ClaimPolicy policy : {ClaimPolicy::Wait, ClaimPolicy::Help, ClaimPolicy::Defer}) {
+        Config c = config;
+        c.claim_policy = policy;
+        c.claim_min_size = 2;
+        c.task_depth = 3;
+        c.task_min_size = 2;
+
+        MemoizationTable<64> cache(c);
+        LowerBound<64> bounds(c, *game);
+        Solver<64> solver(c, *game, cache, bounds);
+
+        StateBitset<64> root;
+        root.set_first(game->num_answers());
+        GuessBitset guesses;
+        guesses.set_first(game->num_guesses());
+
+        std::vector<SearchResult> results(openers.size());
+        #pragma omp parallel for num_threads(4) schedule(dynamic, 1)
+        for (size_t i = 0; i < openers.size(); ++i)
+            results[i] = solver.evaluate_guess(root, openers[i], guesses, 1);
+
+        for (size_t i = 0; i < openers.size(); ++i) {
+            EXPECT_DOUBLE_EQ(results[i].expected_cost, expected[i].expected_cost)
+                << "Guess " << game->get_guess_str(openers[i]) << " policy " << static_cast<int>(policy);
+            EXPECT_EQ(results[i].max_height, expected[i].max_height);
+        }
+    }
+}
+
+// 3. Dropping dominated guesses never changes a cost, only how much of the tree gets searched
+TEST_F(SolverTest, DominanceMatchesOff) {
+    const std::vector<int> openers = {0, 1, 2, 3, 7, 31};
+
+    Config off = config;
+    off.dominance = DominancePolicy::Off;
+    std::vector<SearchResult> expected;
+    for (int guess : openers) expected.push_back(solve_opener(off, guess, false));
+
+    for (DominancePolicy policy : {DominancePolicy::Approximate, DominancePolicy::Exact}) {
+        Config c = config;
+        c.dominance = policy;
+        c.dominance_width = 2;
+
+        t_stats = SolverStats();
+        for (size_t i = 0; i < openers.size(); ++i) {
+            SearchResult res = solve_opener(c, openers[i], false);
+            EXPECT_DOUBLE_EQ(res.expected_cost, expected[i].expected_cost)
+                << "Guess " << game->get_guess_str(openers[i]) << " policy " << static_cast<int>(policy);
+        }
+        EXPECT_GT(t_stats.dominated_pruned, 0);
+    }
+}
+
+// 4. The small state engine gets the same costs as sending those states through the memo and full recursion
+TEST_F(SolverTest, SmallStatesMatchRecursion) {
+    const std::vector<int> openers = {0, 1, 2, 3, 7, 31};
+
+    Config full = config;
+    full.small_state_max = 0;
+
+    for (int limit : {2, 5}) {
+        Config c = config;
+        c.small_state_max = limit;
+
+        t_stats = SolverStats();
+        for (int guess : openers) {
+            SearchResult expected = solve_opener(full, guess, false);
+            SearchResult res = solve_opener(c, guess, false);
+            EXPECT_DOUBLE_EQ(res.expected_cost, expected.expected_cost)
+                << "Guess " << game->get_guess_str(guess) << " limit " << limit;
+            EXPECT_FALSE(res.is_cut);
+        }
+        EXPECT_GT(t_stats.small_solves, 0);
+    }
+}
+
+// 5. Same again, but for 3 to 5 answer states starting at depths 4 and 6, where the depth limit's fail cost comes into it
+// Rhyming families from the full list, playing only each other, so they take long enough to solve for it to matter
+TEST_F(SolverTest, SmallStatesMatchRecursionAtDepthLimit) {
+    Config full = config;
+    full.answers_path = "data/answers.txt";
+    full.guesses_path = "data/answers.txt";
+    full.small_state_max = 0;
+    Config small = full;
+    small.small_state_max = 5;
+
+    Wordle big_game(full);
+    big_game.build_lut();
+
+    std::unordered_map<std::string, int> index_of;
+    for (int i = 0; i < big_game.num_answers(); ++i) index_of[big_game.get_answer_str(i)] = i;
+
+    const std::vector<std::vector<std::string>> families = {
+        {"fight", "light", "might", "night", "right"},
+        {"sight", "tight", "eight", "wight"},
+        {"pound", "round", "found"},
+        {"hatch", "watch", "catch", "latch", "patch"},
+        {"sower", "power", "lower", "tower"},
+    };
+
+    bool hit_limit = false;
+    for (const auto& family : families) {
+        StateBitset<2368> state;
+        GuessBitset guesses;
+        for (const auto& word : family) {
+            state.set(index_of.at(word));
+            guesses.set(index_of.at(word));
+        }
+
+        // evaluate_guess at depth d - 1 hands its buckets to solve_state at depth d. Along with the family itself,
+        // the first word that splits none of them, so the whole state gets handed over
+        std::vector<int> openers;
+        for (int g : guesses) openers.push_back(g);
+        for (int g = 0; g < big_game.num_guesses(); ++g) {
+            std::array<int, NUM_PATTERNS> counts {};
+            big_game.count_patterns(state, g, counts);
+            if (std::count(counts.begin(), counts.end(), static_cast<int>(family.size())) == 1) {
+                openers.push_back(g);
+                break;
+            }
+        }
+        ASSERT_EQ(openers.size(), family.size() + 1);
+
+        for (int depth : {4, 6}) {
+            for (int guess : openers) {
+                MemoizationTable<2368> full_cache(full), small_cache(small);
+                LowerBound<2368> full_bounds(full, big_game), small_bounds(small, big_game);
+                Solver<2368> full_solver(full, big_game, full_cache, full_bounds);
+                Solver<2368> small_solver(small, big_game, small_cache, small_bounds);
+
+                SearchResult expected = full_solver.evaluate_guess(state, guess, guesses, depth - 1);
+                SearchResult res = small_solver.evaluate_guess(state, guess, guesses, depth - 1);
+                EXPECT_DOUBLE_EQ(res.expected_cost, expected.expected_cost)
+                    << family[0] << " family, guess " << big_game.get_guess_str(guess) << " depth " << depth;
+                hit_limit |= expected.expected_cost > 6; // Only a fail cost gets it past 6 guesses
+            }
+        }
+    }
+    EXPECT_TRUE(hit_limit); // Otherwise this never tested the limit at all
+}
+
+// 6. A shared root budget cuts openers that can't beat it with a true lower bound, and leaves the rest exact
+TEST_F(SolverTest, SharedRootBudgetCutsOpeners) {
+    SearchResult exact = solve_opener(config, 7, false);
+
+    MemoizationTable<64> cache(config);
+    LowerBound<64> bounds(config, *game);
+    Solver<64> solver(config, *game, cache, bounds);
+
+    StateBitset<64> root;
+    root.set_first(game->num_answers());
+    GuessBitset guesses;
+    guesses.set_first(game->num_guesses());
+
+    std::atomic<double> budget {exact.expected_cost - 0.1};
+    solver.share_root_budget(&budget);
+
+    SearchResult cut = solver.evaluate_guess(root, 7, guesses, 1);
+    EXPECT_TRUE(cut.is_cut);
+    EXPECT_LE(cut.expected_cost, exact.expected_cost);
+    EXPECT_GT(cut.expected_cost, budget.load());
+
+    budget.store(exact.expected_cost); // Ties are never cut
+    SearchResult tie = solver.evaluate_guess(root, 7, guesses, 1);
+    EXPECT_FALSE(tie.is_cut);
+    EXPECT_DOUBLE_EQ(tie.expected_cost, exact.expected_cost);
+}
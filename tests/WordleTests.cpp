@@ -55,3 +55,70 @@ TEST(WordleLogic, ValidatePatternsWithFile) {
             << "  Actual:   " << pattern_to_string(actual);
     }
 }
+
+TEST(WordleLogic, PartitionMatchesPruneState) {
+    Config config;
+    Wordle game(config);
+    game.build_lut();
+
+    StateBitset<64> state;
+    for (int i = 0; i < game.num_answers(); i += 2) state.set(i);
+
+    Partition<64> partition;
+    for (int guess : {0, 17, 4242, game.num_guesses() - 1}) { // Reusing the partition also checks it clears itself
+        game.partition_state(state, guess, partition);
+
+        int total = 0;
+        int last = -1;
+        for (int i = 0; i < partition.num_patterns; ++i) {
+            Pattern p = partition.patterns[i];
+            EXPECT_GT(p, last) << "Patterns should be ascending";
+            last = p;
+
+            total += partition.counts[p];
+            EXPECT_EQ(partition.counts[p], partition.buckets[p].count());
+        }
+        EXPECT_EQ(total, state.count());
+
+        for (int p = 0; p < NUM_PATTERNS; ++p)
+            EXPECT_TRUE(partition.buckets[p] == game.prune_state(state, guess, p))
+                << "Guess " << game.get_guess_str(guess) << " differs on pattern " << pattern_to_string(p);
+    }
+}
+
+TEST(WordleLogic, SparseStatesMatchDense) {
+    Config config;
+    config.answers_path = "data/answers.txt"; // Full width, so sparse states leave most words empty
+    Wordle game(config);
+    game.build_lut();
+
+    // Wide first, then a few answers in the middle words, then the ends, so each partition has to clear what the last one set
+    StateBitset<2368> wide, middle, ends;
+    for (int i = 0; i < game.num_answers(); i += 3) wide.set(i);
+    for (int i : {700, 701, 765, 900}) middle.set(i);
+    for (int i : {0, game.num_answers() - 1}) ends.set(i);
+
+    EXPECT_EQ(middle.first_word(), 10);
+    EXPECT_EQ(middle.last_word(), 14);
+    EXPECT_GT(StateBitset<2368>().first_word(), StateBitset<2368>().last_word());
+
+    Partition<2368> partition;
+    for (const auto* state : {&wide, &middle, &ends, &wide}) {
+        for (int guess : {0, 4242}) {
+            game.partition_state(*state, guess, partition);
+
+            std::array<int, NUM_PATTERNS> counts;
+            game.count_patterns(*state, guess, counts);
+
+            for (int p = 0; p < NUM_PATTERNS; ++p) {
+                StateBitset<2368> expected;
+                for (int i : *state)
+                    if (game.get_pattern_lookup(guess, i) == p) expected.set(i);
+
+                EXPECT_TRUE(partition.buckets[p] == expected) << "Pattern " << pattern_to_string(p);
+                EXPECT_TRUE(game.prune_state(*state, guess, p) == expected) << "Pattern " << pattern_to_string(p);
+                EXPECT_EQ(counts[p], expected.count());
+            }
+        }
+    }
+}